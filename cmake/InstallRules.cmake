@@ -26,6 +26,22 @@ install(
   DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}"
 )
 
+if(LIBASSERT_BUILD_MODULE)
+  install(
+    TARGETS ${module_target_name}
+    EXPORT ${package_name}-targets
+    ARCHIVE #
+    COMPONENT ${package_name}-development
+    LIBRARY #
+    COMPONENT ${package_name}-runtime
+    RUNTIME #
+    COMPONENT ${package_name}-runtime
+    FILE_SET CXX_MODULES
+    DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}/libassert"
+    COMPONENT ${package_name}-development
+  )
+endif()
+
 # create config file that points to targets file
 configure_file(
   "${PROJECT_SOURCE_DIR}/cmake/in/libassert-config-cmake.in"
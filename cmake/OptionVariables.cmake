@@ -53,6 +53,12 @@ option(
 set(build_testing)
 mark_as_advanced(LIBASSERT_BUILD_TESTING)
 
+option(LIBASSERT_BUILD_BENCHMARKS "Build the libassert-bench benchmark suite" OFF)
+
+# Builds the libassert C++20 module as the libassert::module target, needs CMake 3.28 and a compiler and generator with
+# module support
+option(LIBASSERT_BUILD_MODULE "Build the libassert C++20 module" OFF)
+
 # Adds an extra directory to the include path by default, so that when you link
 # against the target, you get `<prefix>/include/<package-X.Y.Z` added to your
 # include paths rather than `<prefix>/include`.
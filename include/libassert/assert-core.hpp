@@ -0,0 +1,737 @@
+#ifndef LIBASSERT_CORE_HPP
+#define LIBASSERT_CORE_HPP
+
+// Copyright (c) 2021-2024 Jeremy Rifkin under the MIT license
+// https://github.com/jeremy-rifkin/libassert
+
+// The assertion macros and what they need on the success path, without the stringification micro-library, the
+// failure handling interface, or cpptrace. Including this instead of assert.hpp keeps the include graph light, values
+// are then stringified as described at core_stringification.
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <libassert/platform.hpp>
+#include <libassert/utilities.hpp>
+#include <libassert/expression-decomposition.hpp>
+
+#if LIBASSERT_IS_MSVC
+ #pragma warning(push)
+ // warning C4251: using non-dll-exported type in dll-exported type, firing on std::vector<frame_ptr> and others for
+ // some reason
+ // 4275 is the same thing but for base classes
+ #pragma warning(disable: 4251; disable: 4275)
+#endif
+
+// =====================================================================================================================
+// || Libassert core interface                                                                                        ||
+// =====================================================================================================================
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT bool is_debugger_present() noexcept;
+
+    struct binary_diagnostics_descriptor; // in assert.hpp
+
+    enum class assert_type {
+        debug_assertion,
+        assertion,
+        assumption,
+        panic,
+        unreachable
+    };
+
+    namespace detail {
+        struct sv_span {
+            const std::string_view* data;
+            std::size_t size;
+        };
+
+        // collection of assertion data that can be put in static storage and all passed by a single pointer
+        struct LIBASSERT_EXPORT assert_static_parameters {
+            std::string_view macro_name;
+            assert_type type;
+            std::string_view expr_str;
+            source_location location;
+            sv_span args_strings;
+            static_decomposition decomposition;
+        };
+    }
+}
+
+namespace libassert::detail {
+    struct pretty_function_name_wrapper {
+        const char* pretty_function;
+    };
+
+    /*
+     * Emergency reporting, used when the normal path can't allocate
+     */
+
+    // An operand captured without allocating. Only values that can be printed without allocation are kept.
+    struct emergency_value {
+        enum class kind { unavailable, boolean, character, signed_integer, unsigned_integer, pointer, c_string };
+        kind value_kind = kind::unavailable;
+        long long signed_value = 0;
+        unsigned long long unsigned_value = 0;
+        const void* pointer = nullptr;
+    };
+
+    template<typename T>
+    LIBASSERT_ATTR_COLD
+    emergency_value make_emergency_value(const T& t) noexcept {
+        using U = std::decay_t<strip<T>>;
+        using kind = emergency_value::kind;
+        if constexpr(std::is_same_v<U, bool>) {
+            return {kind::boolean, 0, t, nullptr};
+        } else if constexpr(std::is_same_v<U, char>) {
+            return {kind::character, 0, static_cast<unsigned char>(t), nullptr};
+        } else if constexpr(std::is_integral_v<U> && std::is_signed_v<U>) {
+            return {kind::signed_integer, static_cast<long long>(t), 0, nullptr};
+        } else if constexpr(std::is_integral_v<U>) {
+            return {kind::unsigned_integer, 0, static_cast<unsigned long long>(t), nullptr};
+        } else if constexpr(std::is_enum_v<U>) {
+            return make_emergency_value(static_cast<std::underlying_type_t<U>>(t));
+        } else if constexpr(std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+            return {kind::c_string, 0, 0, t};
+        } else if constexpr(std::is_pointer_v<U>) {
+            return {kind::pointer, 0, 0, reinterpret_cast<const void*>(t)};
+        } else if constexpr(std::is_same_v<U, std::nullptr_t>) {
+            return {kind::pointer, 0, 0, nullptr};
+        } else {
+            return {};
+        }
+    }
+
+    /*
+     * Type-erased failure processing
+     */
+
+    // Operations on a type-erased operand or extra argument. One table exists per type rather than one processing
+    // function per assertion signature.
+    struct erased_vtable {
+        std::string (*stringify)(const void*);
+        emergency_value (*emergency)(const void*) noexcept;
+        std::string (*message)(const void*); // nullptr unless the value is a string, i.e. can be the message
+        bool is_character;
+        bool is_arithmetic;
+        bool is_errno_type;
+    };
+
+    struct erased_value {
+        const void* value;
+        const erased_vtable* vtable;
+    };
+
+    template<typename T>
+    LIBASSERT_ATTR_COLD emergency_value erased_emergency_value(const void* value) noexcept {
+        return make_emergency_value(*static_cast<const T*>(value));
+    }
+
+    template<typename T>
+    LIBASSERT_ATTR_COLD std::string erased_message(const void* value) {
+        const T& t = *static_cast<const T*>(value);
+        if constexpr(std::is_pointer_v<T>) {
+            if(t == nullptr) {
+                return "(nullptr)";
+            }
+        }
+        return std::string(t);
+    }
+
+    template<typename T>
+    constexpr auto erased_message_for() noexcept {
+        if constexpr(is_string_type<T>) {
+            return erased_message<T>;
+        } else {
+            return static_cast<std::string(*)(const void*)>(nullptr);
+        }
+    }
+
+    // S is the stringification used for the value, core_stringification below or full_stringification in assert.hpp
+    template<typename S, typename T>
+    inline constexpr erased_vtable erased_vtable_for = {
+        S::template stringify<T>,
+        erased_emergency_value<T>,
+        erased_message_for<T>(),
+        isa<T, char>,
+        is_arith_not_bool_char<T>,
+        isa<T, strip<decltype(errno)>>
+    };
+
+    // character arrays, i.e. string literals, are erased as pointers so each length doesn't get its own table
+    template<typename S, typename C>
+    LIBASSERT_ATTR_COLD std::string erased_char_array_stringify(const void* value) {
+        const C* pointer = static_cast<const C*>(value);
+        return S::template stringify<const C*>(&pointer);
+    }
+
+    template<typename C>
+    LIBASSERT_ATTR_COLD emergency_value erased_char_array_emergency_value(const void* value) noexcept {
+        return make_emergency_value(static_cast<const C*>(value));
+    }
+
+    template<typename C>
+    LIBASSERT_ATTR_COLD std::string erased_char_array_message(const void* value) {
+        return std::string(static_cast<const C*>(value));
+    }
+
+    template<typename S, typename C>
+    inline constexpr erased_vtable erased_char_array_vtable_for = {
+        erased_char_array_stringify<S, C>,
+        erased_char_array_emergency_value<C>,
+        erased_char_array_message<C>,
+        false,
+        false,
+        false
+    };
+
+    template<typename S, typename T>
+    erased_value make_erased_operand(const T& t) noexcept {
+        return {std::addressof(t), &erased_vtable_for<S, T>};
+    }
+
+    // extra arguments that are character arrays use the tables above
+    template<typename S, typename T>
+    constexpr const erased_vtable* erased_arg_vtable() noexcept {
+        if constexpr(std::is_array_v<T> && isa<std::remove_extent_t<T>, char>) {
+            return &erased_char_array_vtable_for<S, std::remove_extent_t<T>>;
+        } else {
+            return &erased_vtable_for<S, T>;
+        }
+    }
+
+    // Fills in the diagnostics for a failed equality comparison of two ranges with where they differ, returns false if
+    // the ranges are short enough to be printed in full. See generate_range_diff in assert.hpp.
+    using erased_range_diff = bool(*)(
+        const void* left,
+        const void* right,
+        std::string_view left_expression,
+        std::string_view right_expression,
+        const arena_allocator<char>& allocator,
+        binary_diagnostics_descriptor& diagnostics
+    );
+
+    // For operands that are only erased to be passed to emergency_fail, which doesn't stringify them. The tables only
+    // have the emergency values so nothing else is instantiated for them.
+    struct emergency_stringification {
+        template<typename A, typename B>
+        static constexpr erased_range_diff range_diff() {
+            return nullptr;
+        }
+    };
+
+    template<typename T>
+    inline constexpr erased_vtable erased_vtable_for<emergency_stringification, T> = {
+        nullptr,
+        erased_emergency_value<T>,
+        nullptr,
+        false,
+        false,
+        false
+    };
+
+    // The types of a failed assertion's values: operand_count operands followed by arg_count extra arguments.
+    // operand_count is 0 for a plain boolean expression, 1 for a value that's checked for truthiness, and 2 for a
+    // decomposed binary expression with operator op. range_diff is only set for == on ranges. One constant table exists
+    // per assertion signature, call sites only pass it along with the addresses of the values it describes.
+    struct erased_signature {
+        const erased_vtable* const* vtables;
+        std::size_t operand_count;
+        std::size_t arg_count;
+        std::string_view op;
+        erased_range_diff range_diff;
+    };
+
+    // nullptr terminated so that the list isn't empty
+    template<const erased_vtable*... vtables>
+    inline constexpr const erased_vtable* erased_vtable_list[] = { vtables..., nullptr }; // NOLINT(*-avoid-c-arrays)
+
+    // A is nothing for an empty decomposer, which is used for assertions without an expression
+    template<typename A, typename C>
+    inline constexpr std::size_t erased_operand_count = is_nothing<C> ? (is_nothing<A> || isa<A, bool> ? 0 : 1) : 2;
+
+    template<typename S, typename A, typename B, typename C, typename... Args>
+    constexpr erased_signature make_erased_signature() noexcept {
+        if constexpr(erased_operand_count<A, C> == 0) {
+            return {erased_vtable_list<erased_arg_vtable<S, Args>()...>, 0, sizeof...(Args), {}, nullptr};
+        } else if constexpr(erased_operand_count<A, C> == 1) {
+            return {
+                erased_vtable_list<&erased_vtable_for<S, strip<A>>, erased_arg_vtable<S, Args>()...>,
+                1,
+                sizeof...(Args),
+                "==",
+                nullptr
+            };
+        } else {
+            erased_range_diff range_diff = nullptr;
+            if constexpr(C::op_string == "==") {
+                range_diff = S::template range_diff<strip<A>, strip<B>>();
+            }
+            return {
+                erased_vtable_list<
+                    &erased_vtable_for<S, strip<A>>,
+                    &erased_vtable_for<S, strip<B>>,
+                    erased_arg_vtable<S, Args>()...
+                >,
+                2,
+                sizeof...(Args),
+                C::op_string,
+                range_diff
+            };
+        }
+    }
+
+    template<typename S, typename A, typename B, typename C, typename... Args>
+    inline constexpr erased_signature erased_signature_for = make_erased_signature<S, A, B, C, Args...>();
+
+    // What's passed to the library for a failed assertion. values only lives until the end of the full-expression that
+    // erased the assertion.
+    struct erased_arguments {
+        const erased_signature* signature;
+        const void* const* values;
+    };
+
+    // the signature is a template parameter so that only the addresses are stored at the call site
+    template<const erased_signature* signature, std::size_t N>
+    struct erased_values {
+        const void* values[N]; // NOLINT(*-avoid-c-arrays)
+
+        operator erased_arguments() const noexcept { // NOLINT(*-explicit-constructor)
+            return {signature, values};
+        }
+    };
+
+    template<const erased_signature* signature>
+    struct erased_values<signature, 0> {
+        operator erased_arguments() const noexcept { // NOLINT(*-explicit-constructor)
+            return {signature, nullptr};
+        }
+    };
+
+    // Only gathers addresses, the types go in the signature's table
+    template<typename S, typename A, typename B, typename C, typename... Args>
+    erased_values<&erased_signature_for<S, A, B, C, Args...>, erased_operand_count<A, C> + sizeof...(Args)>
+    erase_assertion(const expression_decomposer<A, B, C>& decomposer, const Args&... args) noexcept {
+        if constexpr(erased_operand_count<A, C> == 0 && sizeof...(Args) == 0) {
+            (void)decomposer;
+            return {};
+        } else if constexpr(erased_operand_count<A, C> == 0) {
+            (void)decomposer;
+            return {{std::addressof(args)...}};
+        } else if constexpr(erased_operand_count<A, C> == 1) {
+            return {{std::addressof(decomposer.a), std::addressof(args)...}};
+        } else {
+            return {{std::addressof(decomposer.a), std::addressof(decomposer.b), std::addressof(args)...}};
+        }
+    }
+
+    // Stringification used when only assert-core.hpp is available: libassert::stringifier specializations, strings,
+    // pointers, enums, and arithmetic types. Anything else is printed as an instance of its type, including types that
+    // assert.hpp would print as containers or with an ostream overload.
+    struct core_stringification {
+        template<typename T>
+        LIBASSERT_ATTR_COLD static std::string stringify(const void* value) {
+            return fit_stringification_budget(stringify_value(*static_cast<const T*>(value)));
+        }
+
+        // ranges aren't stringified as such, so there's nothing to diff
+        template<typename A, typename B>
+        static constexpr erased_range_diff range_diff() {
+            return nullptr;
+        }
+
+        template<typename T>
+        LIBASSERT_ATTR_COLD static std::string stringify_value(const T& v) {
+            if constexpr(stringification::has_stringifier<T>::value) {
+                return stringifier<strip<T>>{}.stringify(v);
+            } else if constexpr(std::is_same_v<T, std::nullptr_t>) {
+                return "nullptr";
+            } else if constexpr(std::is_convertible_v<T, std::string_view>) {
+                if constexpr(std::is_pointer_v<T>) {
+                    if(v == nullptr) {
+                        return "nullptr";
+                    }
+                }
+                return stringification::stringify(std::string_view(v));
+            } else if constexpr(std::is_pointer_v<T>) {
+                return prettify_type(std::string(type_name<T>())) + ": "
+                    + stringification::stringify_pointer_value(reinterpret_cast<const void*>(v));
+            } else if constexpr(std::is_enum_v<T>) {
+                return bstringf(
+                    "enum %s: %s",
+                    prettify_type(std::string(type_name<T>())).c_str(),
+                    stringification::stringify(static_cast<std::underlying_type_t<T>>(v)).c_str()
+                );
+            } else if constexpr(std::is_arithmetic_v<T>) {
+                return stringification::stringify(v);
+            } else {
+                return stringification::stringify_unknown<T>();
+            }
+        }
+    };
+
+    // args comes from erase_assertion at the call site, so all that's instantiated per assertion signature is its
+    // constant table and the vtables of each type involved
+    LIBASSERT_EXPORT void process_assert_fail_erased(
+        const assert_static_parameters* params,
+        erased_arguments args,
+        pretty_function_name_wrapper pretty_function
+    );
+
+    [[noreturn]] LIBASSERT_EXPORT void process_panic_erased(
+        const assert_static_parameters* params,
+        erased_arguments args,
+        pretty_function_name_wrapper pretty_function
+    );
+
+    /*
+     * Sampled assertions
+     */
+
+    // cheap per-thread xorshift32, seeded from the address of the thread's state
+    inline std::uint32_t sampling_prng() noexcept {
+        thread_local std::uint32_t state = 0;
+        if(state == 0) {
+            state = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&state) >> 4) | 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Per-call-site state for ASSERT_SAMPLED and ASSERT_EVERY_N. Sites register themselves on first use so their rate
+    // can be adjusted at runtime with set_sampling_rate.
+    class LIBASSERT_EXPORT sampling_site {
+    public:
+        enum class kind {
+            sampled, // value is a threshold for sampling_prng(), the probability scaled by 2^32
+            every_n // value is the period
+        };
+        sampling_site(kind site_kind, double rate_or_period, std::string_view file, std::uint32_t line);
+        ~sampling_site();
+        sampling_site(const sampling_site&) = delete;
+        sampling_site(sampling_site&&) = delete;
+        sampling_site& operator=(const sampling_site&) = delete;
+        sampling_site& operator=(sampling_site&&) = delete;
+
+        // counter is the site's thread-local countdown, only used for every_n sites
+        [[nodiscard]] bool sample(std::uint32_t& counter) noexcept {
+            const std::uint32_t current = value.load(std::memory_order_relaxed);
+            if(site_kind == kind::every_n) {
+                if(counter == 0) {
+                    counter = current - 1;
+                    return true;
+                }
+                counter--;
+                return false;
+            } else {
+                return current == std::numeric_limits<std::uint32_t>::max() || sampling_prng() < current;
+            }
+        }
+
+        bool matches(std::string_view file, std::uint32_t line) const;
+        void set_rate(double rate);
+
+    private:
+        kind site_kind;
+        std::atomic<std::uint32_t> value;
+        std::string_view file;
+        std::uint32_t line;
+    };
+
+    /*
+     * Site counters
+     */
+
+    // Evaluation and failure counts of an assertion site in a LIBASSERT_SITE_COUNTERS translation unit. Sites register
+    // themselves on first use, see get_site_counts. Each site gets its own cache line so that hot sites next to each
+    // other in static storage don't contend.
+    class LIBASSERT_EXPORT site_counter {
+    public:
+        explicit site_counter(const assert_static_parameters* params);
+        ~site_counter();
+        site_counter(const site_counter&) = delete;
+        site_counter(site_counter&&) = delete;
+        site_counter& operator=(const site_counter&) = delete;
+        site_counter& operator=(site_counter&&) = delete;
+
+        void count_evaluation() noexcept {
+            evaluations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_failure() noexcept {
+            failures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        alignas(64) const assert_static_parameters* params;
+        std::atomic<std::uint64_t> evaluations;
+        std::atomic<std::uint64_t> failures;
+    };
+
+    /*
+     * Range assertions
+     */
+
+    // The checks for ASSERT_ALL, ASSERT_ALL_IN_RANGE, and ASSERT_NONE_NAN. These are called on every element of the
+    // range so they're kept to a branch-free comparison wherever the element type allows it.
+    template<typename P>
+    struct predicate_check {
+        P pred;
+        template<typename T>
+        constexpr bool operator()(const T& value) {
+            return static_cast<bool>(pred(value));
+        }
+    };
+
+    template<typename P>
+    constexpr predicate_check<std::decay_t<P>> make_predicate_check(P&& pred) {
+        return {std::forward<P>(pred)};
+    }
+
+    // Without LIBASSERT_SAFE_COMPARISONS bounds are compared as written, like the decomposer does. The mixed sign
+    // comparison is the user's, it shouldn't warn from inside the library.
+    #if LIBASSERT_IS_GCC || LIBASSERT_IS_CLANG
+     #pragma GCC diagnostic push
+     #pragma GCC diagnostic ignored "-Wsign-compare"
+    #elif LIBASSERT_IS_MSVC
+     #pragma warning(push)
+     #pragma warning(disable: 4018)
+    #endif
+    template<typename A, typename B>
+    constexpr bool range_less_equal(const A& a, const B& b) {
+        #ifdef LIBASSERT_SAFE_COMPARISONS
+         if constexpr(is_integral_and_not_bool<A> && is_integral_and_not_bool<B>) {
+             return cmp_less_equal(a, b);
+         } else {
+             return a <= b;
+         }
+        #else
+         return a <= b;
+        #endif
+    }
+    #if LIBASSERT_IS_GCC || LIBASSERT_IS_CLANG
+     #pragma GCC diagnostic pop
+    #elif LIBASSERT_IS_MSVC
+     #pragma warning(pop)
+    #endif
+
+    // the bounds are inclusive
+    template<typename L, typename H>
+    struct bounds_check {
+        L lo;
+        H hi;
+        template<typename T>
+        constexpr bool operator()(const T& value) const {
+            // & rather than && so both comparisons are done unconditionally
+            return range_less_equal(lo, value) & range_less_equal(value, hi);
+        }
+    };
+
+    template<typename L, typename H>
+    constexpr bounds_check<std::decay_t<L>, std::decay_t<H>> make_bounds_check(L&& lo, H&& hi) {
+        return {std::forward<L>(lo), std::forward<H>(hi)};
+    }
+
+    struct not_nan_check {
+        template<typename T>
+        constexpr bool operator()(const T& value) const {
+            static_assert(std::is_floating_point_v<T>, "ASSERT_NONE_NAN requires a range of floating point values");
+            return value == value; // NOLINT(misc-redundant-expression)
+        }
+    };
+
+    template<typename R, typename = void>
+    struct is_contiguous_arithmetic_range : std::false_type {};
+
+    template<typename R>
+    struct is_contiguous_arithmetic_range<
+        R,
+        std::void_t<decltype(std::data(std::declval<const R&>())), decltype(std::size(std::declval<const R&>()))>
+    > : std::is_arithmetic<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<const R&>()))>>> {};
+
+    inline constexpr std::size_t no_failing_element = std::numeric_limits<std::size_t>::max();
+
+    // Index of the first element the check fails for, or no_failing_element. Contiguous ranges of arithmetic values are
+    // checked a block at a time with no early exit inside the block, which the compiler can vectorize. Once a block
+    // fails the remainder is searched an element at a time, so the check is called a second time on the elements of the
+    // failing block up to the failing one. Keeping each element's result instead would defeat the vectorization.
+    template<typename R, typename C>
+    std::size_t find_failing_element(const R& range, C& check) {
+        if constexpr(is_contiguous_arithmetic_range<R>::value) {
+            const auto* data = std::data(range);
+            const std::size_t size = std::size(range);
+            constexpr std::size_t block_size = 64;
+            std::size_t start = 0;
+            // counting passing elements in an unsigned integer the width of the element keeps the whole loop in one
+            // vector shape, a bool accumulator doesn't vectorize
+            using element_type = std::remove_cv_t<std::remove_reference_t<decltype(*data)>>;
+            using counter_type = std::conditional_t<
+                sizeof(element_type) >= 8,
+                std::uint64_t,
+                std::conditional_t<
+                    sizeof(element_type) == 4,
+                    std::uint32_t,
+                    std::conditional_t<sizeof(element_type) == 2, std::uint16_t, std::uint8_t>
+                >
+            >;
+            for(; start + block_size <= size; start += block_size) {
+                counter_type passed = 0;
+                for(std::size_t i = 0; i < block_size; i++) {
+                    passed += check(data[start + i]);
+                }
+                if(passed != block_size) {
+                    break;
+                }
+            }
+            for(std::size_t i = start; i < size; i++) {
+                if(!check(data[i])) {
+                    return i;
+                }
+            }
+            return no_failing_element;
+        } else {
+            using std::begin, std::end;
+            std::size_t index = 0;
+            for(auto it = begin(range), last = end(range); it != last; ++it, ++index) {
+                if(!check(*it)) {
+                    return index;
+                }
+            }
+            return no_failing_element;
+        }
+    }
+
+    // The first failing element of a range assertion. bound is the bound of ASSERT_ALL_IN_RANGE that the element is
+    // outside of, op is how the element should have compared to it. bound has no vtable for the other assertions.
+    struct erased_range_failure {
+        std::string_view range_expression;
+        std::size_t index;
+        erased_value element;
+        erased_value bound;
+        std::string_view bound_expression;
+        std::string_view op;
+    };
+
+    LIBASSERT_EXPORT void process_range_assert_fail_erased(
+        const assert_static_parameters* params,
+        const erased_range_failure& failure,
+        erased_arguments args,
+        pretty_function_name_wrapper pretty_function
+    );
+
+    template<typename T>
+    struct is_bounds_check : std::false_type {};
+
+    template<typename L, typename H>
+    struct is_bounds_check<bounds_check<L, H>> : std::true_type {};
+
+    // Walks back to the failing element, which has to be alive for as long as it's referenced by the erased failure
+    template<typename S, typename R, typename C>
+    LIBASSERT_ATTR_COLD LIBASSERT_ATTR_NOINLINE void process_range_assert_fail(
+        const assert_static_parameters* params,
+        const R& range,
+        const C& check,
+        std::size_t index,
+        std::string_view range_expression,
+        std::string_view lo_expression,
+        std::string_view hi_expression,
+        erased_arguments args,
+        pretty_function_name_wrapper pretty_function
+    ) {
+        using std::begin;
+        auto it = begin(range);
+        for(std::size_t i = 0; i < index; i++) {
+            ++it;
+        }
+        decltype(auto) element = *it;
+        erased_range_failure failure{range_expression, index, make_erased_operand<S>(element), {}, {}, {}};
+        if constexpr(is_bounds_check<C>::value) {
+            if(!range_less_equal(check.lo, element)) {
+                failure.bound = make_erased_operand<S>(check.lo);
+                failure.bound_expression = lo_expression;
+                failure.op = ">=";
+            } else {
+                failure.bound = make_erased_operand<S>(check.hi);
+                failure.bound_expression = hi_expression;
+                failure.op = "<=";
+            }
+        } else {
+            (void)check;
+            (void)lo_expression;
+            (void)hi_expression;
+        }
+        process_range_assert_fail_erased(params, failure, args, pretty_function);
+    }
+
+    template<typename T>
+    struct assert_value_wrapper {
+        T value;
+    };
+
+    template<
+        bool R, bool ret_lhs, bool value_is_lval_ref,
+        typename T, typename A, typename B, typename C
+    >
+    constexpr auto get_expression_return_value(T& value, expression_decomposer<A, B, C>& decomposer) {
+        if constexpr(R) {
+            if constexpr(ret_lhs) {
+                if constexpr(std::is_lvalue_reference_v<A>) {
+                    return assert_value_wrapper<A>{decomposer.take_lhs()};
+                } else {
+                    return assert_value_wrapper<A>{std::move(decomposer.take_lhs())};
+                }
+            } else {
+                if constexpr(value_is_lval_ref) {
+                    return assert_value_wrapper<T&>{value};
+                } else {
+                    return assert_value_wrapper<T>{std::move(value)};
+                }
+            }
+        }
+    }
+}
+
+#if LIBASSERT_IS_MSVC
+ #pragma warning(pop)
+#endif
+
+namespace libassert {
+    inline void ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT() {
+        // This non-constexpr method is called from an assertion in a constexpr context if a failure occurs. It is
+        // intentionally a no-op.
+    }
+}
+
+// Workaround for gcc bug 105734 / libassert bug #24, see LIBASSERT_DESTROY_DECOMPOSER
+#if LIBASSERT_IS_GCC
+ #if __GNUC__ == 12 && __GNUC_MINOR__ == 1
+  namespace libassert::detail {
+      template<typename T> constexpr void destroy(T& t) {
+          t.~T();
+      }
+  }
+ #endif
+#endif
+
+#if !(LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC)
+ // Workaround for msvc bug, see LIBASSERT_STATIC_CAST_TO_BOOL
+ namespace libassert::detail {
+     template<typename T> constexpr bool static_cast_to_bool(T&& t) {
+         return static_cast<bool>(t);
+     }
+ }
+#endif
+
+#endif // LIBASSERT_CORE_HPP
+
+#include <libassert/assert-macros.hpp>
@@ -4,9 +4,15 @@
 // Copyright (c) 2021-2024 Jeremy Rifkin under the MIT license
 // https://github.com/jeremy-rifkin/libassert
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <new>
 #include <optional>
@@ -20,6 +26,7 @@
 #include <variant>
 #include <vector>
 
+#include <libassert/assert-core.hpp>
 #include <libassert/platform.hpp>
 #include <libassert/utilities.hpp>
 #include <libassert/stringification.hpp>
@@ -60,7 +67,6 @@ namespace libassert {
 
     LIBASSERT_ATTR_COLD LIBASSERT_EXPORT bool isatty(int fd);
 
-    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT bool is_debugger_present() noexcept;
     enum class debugger_check_mode {
         check_once,
         check_every_time,
@@ -166,34 +172,74 @@ namespace libassert {
     };
     LIBASSERT_EXPORT void set_path_mode(path_mode mode);
 
-    enum class assert_type {
-        debug_assertion,
-        assertion,
-        assumption,
-        panic,
-        unreachable
-    };
-
     struct assertion_info;
 
     [[noreturn]] LIBASSERT_EXPORT void default_failure_handler(const assertion_info& info);
+    // Writes the failure as a single line of JSON to the fd set with set_json_output_fd (stderr by default) in one write
+    // call, then aborts like default_failure_handler
+    [[noreturn]] LIBASSERT_EXPORT void json_failure_handler(const assertion_info& info);
+    LIBASSERT_EXPORT void set_json_output_fd(int fd);
 
     using handler_ptr = void(*)(const assertion_info&);
     LIBASSERT_EXPORT handler_ptr get_failure_handler();
     LIBASSERT_EXPORT void set_failure_handler(handler_ptr handler);
 
+    enum class reporting_mode {
+        // the failure handler is called on the failing thread
+        synchronous,
+        // failures of non-fatal assertion types are queued and the failure handler is called from a background thread
+        deferred
+    };
+    LIBASSERT_EXPORT void set_reporting_mode(reporting_mode mode);
+    // blocks until every failure queued so far has been passed to its handler
+    LIBASSERT_EXPORT void flush_deferred_reports();
+
+    // Adjusts the rate of ASSERT_SAMPLED / ASSERT_EVERY_N sites at a given line of a file. file is matched against the
+    // end of the site's path. Applies to sites that haven't run yet too. Returns the number of sites already running
+    // which were updated.
+    LIBASSERT_EXPORT std::size_t set_sampling_rate(std::string_view file, std::uint32_t line, double rate);
+
+    // Once a call site has failed max_reports times, further failures there are only counted and not passed to the
+    // failure handler. A summary line is written to stderr at most once every summary_interval milliseconds per site,
+    // and at exit for failures suppressed since the last one. With per_stack_trace each distinct stack trace into a
+    // site is counted separately. max_reports = 0 disables suppression, which is the default. Panics and unreachables
+    // are never suppressed.
+    LIBASSERT_EXPORT void set_failure_suppression(
+        std::size_t max_reports,
+        bool per_stack_trace = false,
+        std::uint64_t summary_interval = 10000
+    );
+    // Forgets all counted failures, every site reports up to max_reports times again. Failures counted while this runs
+    // may be lost.
+    LIBASSERT_EXPORT void reset_failure_suppression();
+
+    // Gives each thread a preallocated arena of this many bytes. While a failure is reported on the thread, the
+    // assertion_info built for it allocates its strings, vectors, raw trace and path handling from the arena, as does
+    // the report assembled from it. Reset at the start of the thread's next failure, copies of the assertion_info use
+    // the global allocator. 0 disables arenas, which is the default.
+    LIBASSERT_EXPORT void set_failure_arena_size(std::size_t bytes);
+
+    // Bounds the size of stringified values in failure reports. Once a value's stringification reaches value_bytes, or
+    // everything stringified for one assertion failure reaches assertion_bytes, strings are cut off and containers and
+    // tuples stop, marking what was left out with "...". 0 removes a limit. The defaults are 64KiB and 256KiB.
+    LIBASSERT_EXPORT void set_stringification_budget(std::size_t value_bytes, std::size_t assertion_bytes);
+
     struct LIBASSERT_EXPORT binary_diagnostics_descriptor {
-        std::string left_expression;
-        std::string right_expression;
-        std::string left_stringification;
-        std::string right_stringification;
+        arena_string left_expression;
+        arena_string right_expression;
+        arena_string left_stringification;
+        arena_string right_stringification;
         bool multiple_formats;
+        // For == on long ranges: the size mismatch and the first differing elements, one per line. The
+        // stringifications then only show the elements around the first difference.
+        arena_vector<arena_string> range_differences;
         binary_diagnostics_descriptor(); // = default; in the .cpp
+        // everything is allocated with left_stringification's allocator
         binary_diagnostics_descriptor(
             std::string_view left_expression,
             std::string_view right_expression,
-            std::string&& left_stringification,
-            std::string&& right_stringification,
+            arena_string&& left_stringification,
+            arena_string&& right_stringification,
             bool multiple_formats
         );
         ~binary_diagnostics_descriptor(); // = default; in the .cpp
@@ -201,27 +247,12 @@ namespace libassert {
         binary_diagnostics_descriptor(binary_diagnostics_descriptor&&) noexcept;
         binary_diagnostics_descriptor& operator=(const binary_diagnostics_descriptor&);
         binary_diagnostics_descriptor& operator=(binary_diagnostics_descriptor&&) noexcept(LIBASSERT_GCC_ISNT_STUPID);
+        void add_range_difference(std::string_view difference);
     };
 
-    namespace detail {
-        struct sv_span {
-            const std::string_view* data;
-            std::size_t size;
-        };
-
-        // collection of assertion data that can be put in static storage and all passed by a single pointer
-        struct LIBASSERT_EXPORT assert_static_parameters {
-            std::string_view macro_name;
-            assert_type type;
-            std::string_view expr_str;
-            source_location location;
-            sv_span args_strings;
-        };
-    }
-
     struct extra_diagnostic {
         std::string_view expression;
-        std::string stringification;
+        arena_string stringification;
     };
 
     namespace detail {
@@ -234,8 +265,77 @@ namespace libassert {
             virtual void add_path(std::string_view);
             virtual void finalize();
         };
+
+        // counts the failure for set_failure_suppression, true if it shouldn't be reported. Checked before anything
+        // about the failure is captured.
+        LIBASSERT_EXPORT bool should_suppress(const assert_static_parameters* params);
+        // emergency_fail for a report that couldn't be written because an allocation failed
+        [[noreturn]] void emergency_fail(const assertion_info& info) noexcept;
     }
 
+    // Destination for assertion_info::write_report. The report is passed along in pieces as it's generated, a piece is
+    // only valid for the duration of the call.
+    class LIBASSERT_EXPORT report_sink {
+    public:
+        virtual ~report_sink() = default;
+        virtual void write(std::string_view) = 0;
+        // called before the report waits on anything slow, e.g. stack trace resolution
+        virtual void flush() {}
+    };
+
+    // Writes to a file descriptor through a fixed size buffer
+    class LIBASSERT_EXPORT fd_sink : public report_sink {
+        int fd;
+        std::size_t used = 0;
+        char buffer[4096];
+    public:
+        explicit fd_sink(int fd);
+        ~fd_sink() override;
+        fd_sink(const fd_sink&) = delete;
+        fd_sink& operator=(const fd_sink&) = delete;
+        void write(std::string_view) override;
+        void flush() override;
+    };
+
+    // Writes into a caller supplied buffer, anything that doesn't fit is dropped
+    class LIBASSERT_EXPORT buffer_sink : public report_sink {
+        char* data;
+        std::size_t capacity;
+        std::size_t used = 0;
+        bool overflowed = false;
+    public:
+        buffer_sink(char* data, std::size_t capacity);
+        void write(std::string_view) override;
+        std::string_view view() const;
+        bool truncated() const;
+    };
+
+    // Passes each piece of the report to a callback
+    class LIBASSERT_EXPORT callback_sink : public report_sink {
+        void (*callback)(void* context, std::string_view);
+        void* context;
+    public:
+        explicit callback_sink(void (*callback)(void* context, std::string_view), void* context = nullptr);
+        void write(std::string_view) override;
+    };
+
+    // How often an assertion site has been checked and how often it failed. Only sites in translation units built with
+    // LIBASSERT_SITE_COUNTERS are counted, from the first time they're reached.
+    struct site_counts {
+        std::string_view macro_name;
+        std::string_view expression;
+        std::string_view file;
+        std::uint32_t line;
+        std::uint64_t evaluations;
+        std::uint64_t failures;
+    };
+
+    // Every counted site, most evaluated first. Instantiations of a template count as one site.
+    LIBASSERT_EXPORT std::vector<site_counts> get_site_counts();
+    LIBASSERT_EXPORT void reset_site_counts();
+    // Writes get_site_counts() as a table, one line per site
+    LIBASSERT_EXPORT void write_site_counts(report_sink& sink);
+
     struct LIBASSERT_EXPORT assertion_info {
         std::string_view macro_name;
         assert_type type;
@@ -243,28 +343,45 @@ namespace libassert {
         std::string_view file_name;
         std::uint32_t line;
         std::string_view function;
-        std::optional<std::string> message;
+        std::optional<arena_string> message;
         std::optional<binary_diagnostics_descriptor> binary_diagnostics;
-        std::vector<extra_diagnostic> extra_diagnostics;
+        arena_vector<extra_diagnostic> extra_diagnostics;
         size_t n_args;
     private:
-        mutable std::variant<cpptrace::raw_trace, cpptrace::stacktrace> trace; // lazy, resolved when needed
+        const detail::assert_static_parameters* static_params; // identifies the call site
+        detail::monotonic_arena* arena; // what everything above is allocated from, nullptr for the global allocator
+        // lazy, resolved when needed, the frames are only a raw_trace once get_raw_trace asks for one
+        mutable std::variant<cpptrace::raw_trace, cpptrace::stacktrace, arena_vector<cpptrace::frame_ptr>> trace;
         mutable std::unique_ptr<detail::path_handler> path_handler;
         detail::path_handler* get_path_handler() const; // will get and setup the path handler
+        void write_tagline(report_sink& sink, const color_scheme& scheme) const; // shared by tagline and write_report
+        std::string_view header_file_name() const; // file_name as shown in the tagline, doesn't resolve the trace
+        friend void detail::emergency_fail(const assertion_info& info) noexcept;
     public:
+        using allocator_type = detail::arena_allocator<char>;
+
         assertion_info() = delete;
         assertion_info(
             const detail::assert_static_parameters* static_params,
             cpptrace::raw_trace&& raw_trace,
             size_t n_args
         );
+        // captures the raw trace itself, everything is allocated from the arena if one is given
+        assertion_info(
+            const detail::assert_static_parameters* static_params,
+            size_t n_args,
+            detail::monotonic_arena* arena
+        );
         ~assertion_info();
+        // copies use the global allocator, and so do moves from an assertion_info that's in an arena
         assertion_info(const assertion_info&);
         assertion_info(assertion_info&&);
         assertion_info& operator=(const assertion_info&);
         assertion_info& operator=(assertion_info&&);
 
         std::string_view action() const;
+        // for anything added to the diagnostics
+        allocator_type get_allocator() const noexcept;
 
         const cpptrace::raw_trace& get_raw_trace() const;
         const cpptrace::stacktrace& get_stacktrace() const;
@@ -278,6 +395,11 @@ namespace libassert {
         [[nodiscard]] std::string print_stacktrace(int width = 0, const color_scheme& scheme = get_color_scheme()) const;
 
         [[nodiscard]] std::string to_string(int width = 0, const color_scheme& scheme = get_color_scheme()) const;
+        // writes the same report as to_string incrementally, the header is written before the trace is resolved
+        void write_report(report_sink& sink, int width = 0, const color_scheme& scheme = get_color_scheme()) const;
+        // compact single line JSON record, uncolored and without a trailing newline
+        [[nodiscard]] std::string to_json() const;
+        void write_json(report_sink& sink) const;
     };
 }
 
@@ -311,6 +433,12 @@ namespace libassert::detail {
         std::string_view target_op
     );
 
+    // same as above but memoized per call site
+    [[nodiscard]] LIBASSERT_EXPORT std::pair<std::string, std::string> decompose_expression(
+        const assert_static_parameters* params,
+        std::string_view target_op
+    );
+
     /*
      * System wrappers
      */
@@ -321,6 +449,227 @@ namespace libassert::detail {
      * assert diagnostics generation
      */
 
+    // Equality assertions on ranges with more elements than this report where they differ instead of printing both
+    inline constexpr std::size_t range_diff_min_size = 64;
+    inline constexpr std::size_t range_diff_max_differences = 8;
+    // elements shown on either side of the first difference
+    inline constexpr std::size_t range_diff_context = 3;
+
+    namespace range_diff_adl {
+        using std::begin; // ADL
+        template<typename T> using iterator = decltype(begin(decllval<const T>()));
+    }
+
+    // Unordered containers compare equal regardless of the order of their elements, they can't be diffed by position
+    template<typename T, typename = void>
+    class is_unordered_container : public std::false_type {};
+    template<typename T>
+    class is_unordered_container<
+        T,
+        std::void_t<typename T::hasher, typename T::key_equal>
+    > : public std::true_type {};
+
+    // Ranges of the same element type that can be walked more than once, i.e. their iterators can be kept around
+    template<typename A, typename B, typename = void>
+    class is_range_diffable : public std::false_type {};
+    template<typename A, typename B>
+    class is_range_diffable<
+        A,
+        B,
+        std::enable_if_t<
+            std::is_base_of_v<
+                std::forward_iterator_tag,
+                typename std::iterator_traits<range_diff_adl::iterator<A>>::iterator_category
+            >
+            && std::is_base_of_v<
+                std::forward_iterator_tag,
+                typename std::iterator_traits<range_diff_adl::iterator<B>>::iterator_category
+            >
+            && std::is_same_v<
+                strip<decltype(*std::declval<range_diff_adl::iterator<A>>())>,
+                strip<decltype(*std::declval<range_diff_adl::iterator<B>>())>
+            >
+            && std::is_convertible_v<
+                decltype(
+                    *std::declval<range_diff_adl::iterator<A>>() == *std::declval<range_diff_adl::iterator<B>>()
+                ),
+                bool
+            >
+        >
+    > : public std::bool_constant<
+        !is_string_type<A> && !is_string_type<B>
+        && !std::is_same_v<A, std::filesystem::path> && !std::is_same_v<B, std::filesystem::path>
+        && stringifiable_container<A>() && stringifiable_container<B>()
+        && !is_unordered_container<A>::value && !is_unordered_container<B>::value
+    > {};
+
+    // Values that are equal exactly when their bytes are
+    template<typename T> inline constexpr bool is_bytewise_comparable =
+        (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>)
+        && std::has_unique_object_representations_v<T>;
+
+    // Contiguous ranges of the same bytewise comparable element type
+    template<typename A, typename B, typename = void>
+    class is_bytewise_comparable_range_pair : public std::false_type {};
+    template<typename A, typename B>
+    class is_bytewise_comparable_range_pair<
+        A,
+        B,
+        std::void_t<decltype(std::data(std::declval<const A&>())), decltype(std::data(std::declval<const B&>()))>
+    > : public std::bool_constant<
+        std::is_same_v<decltype(std::data(std::declval<const A&>())), decltype(std::data(std::declval<const B&>()))>
+        && is_bytewise_comparable<strip<decltype(*std::data(std::declval<const A&>()))>>
+    > {};
+
+    // Index of the first difference at or after i, or size. Equal runs are skipped a block at a time with memcmp.
+    template<typename T>
+    std::size_t find_bytewise_difference(const T* left, const T* right, std::size_t i, std::size_t size) {
+        constexpr std::size_t block = 512;
+        while(i < size) {
+            const std::size_t n = std::min(block, size - i);
+            if(std::memcmp(left + i, right + i, n * sizeof(T)) != 0) {
+                while(left[i] == right[i]) {
+                    i++;
+                }
+                return i;
+            }
+            i += n;
+        }
+        return size;
+    }
+
+    // Stringifies the elements of a range starting at the given index, with "..." marking the elements left out
+    template<typename T, typename It>
+    LIBASSERT_ATTR_COLD [[nodiscard]]
+    arena_string stringify_range_window(
+        const T& range,
+        It it,
+        std::size_t index,
+        std::size_t count,
+        const arena_allocator<char>& allocator
+    ) {
+        using std::end; // ADL
+        const stringification_budget_scope budget_scope(stringification_budget_scope::value);
+        std::string str = prettify_type(std::string(type_name<T>()));
+        str += ": [";
+        if(index != 0) {
+            str += "..., ";
+        }
+        for(std::size_t i = 0; i < count && it != end(range); i++, ++it) {
+            if(i != 0) {
+                str += ", ";
+            }
+            do_stringify_into(str, *it);
+        }
+        if(it != end(range)) {
+            str += ", ...";
+        }
+        str += "]";
+        return arena_string(str, allocator);
+    }
+
+    // Walks both ranges once, comparing elements pairwise. Only the elements around the first difference and the
+    // first range_diff_max_differences differing pairs are stringified, however large the ranges are.
+    // Runs of equal elements are skipped with memcmp or std::mismatch where possible.
+    template<typename A, typename B>
+    LIBASSERT_ATTR_COLD [[nodiscard]]
+    std::optional<binary_diagnostics_descriptor> generate_range_diff(
+        const A& left,
+        const B& right,
+        std::string_view left_str,
+        std::string_view right_str,
+        const arena_allocator<char>& allocator
+    ) {
+        using std::begin, std::end; // ADL
+        struct difference {
+            std::size_t index;
+            range_diff_adl::iterator<A> left;
+            range_diff_adl::iterator<B> right;
+        };
+        std::vector<difference> differences;
+        std::size_t n_differences = 0;
+        auto left_it = begin(left);
+        auto right_it = begin(right);
+        std::size_t index = 0;
+        if constexpr(is_bytewise_comparable_range_pair<A, B>::value) {
+            const std::size_t common = std::min(std::size(left), std::size(right));
+            for(
+                index = find_bytewise_difference(std::data(left), std::data(right), 0, common);
+                index < common;
+                index = find_bytewise_difference(std::data(left), std::data(right), index + 1, common)
+            ) {
+                if(n_differences++ < range_diff_max_differences) {
+                    differences.push_back({index, std::next(left_it, index), std::next(right_it, index)});
+                }
+            }
+            left_it = std::next(left_it, common);
+            right_it = std::next(right_it, common);
+        } else {
+            while(true) {
+                // skip to the next difference
+                if constexpr(
+                    std::is_base_of_v<
+                        std::random_access_iterator_tag,
+                        typename std::iterator_traits<range_diff_adl::iterator<A>>::iterator_category
+                    >
+                ) {
+                    const auto [left_next, right_next] = std::mismatch(left_it, end(left), right_it, end(right));
+                    index += static_cast<std::size_t>(left_next - left_it);
+                    left_it = left_next;
+                    right_it = right_next;
+                } else {
+                    while(left_it != end(left) && right_it != end(right) && *left_it == *right_it) {
+                        ++left_it;
+                        ++right_it;
+                        ++index;
+                    }
+                }
+                if(left_it == end(left) || right_it == end(right)) {
+                    break;
+                }
+                if(n_differences++ < range_diff_max_differences) {
+                    differences.push_back({index, left_it, right_it});
+                }
+                ++left_it;
+                ++right_it;
+                ++index;
+            }
+        }
+        const std::size_t left_size = index + static_cast<std::size_t>(std::distance(left_it, end(left)));
+        const std::size_t right_size = index + static_cast<std::size_t>(std::distance(right_it, end(right)));
+        if(std::max(left_size, right_size) <= range_diff_min_size || (n_differences == 0 && left_size == right_size)) {
+            return std::nullopt;
+        }
+        // either the first differing element or where the shorter range ends
+        const std::size_t first = n_differences == 0 ? index : differences.front().index;
+        const std::size_t window_index = first > range_diff_context ? first - range_diff_context : 0;
+        const std::size_t window_size = first - window_index + range_diff_context + 1;
+        binary_diagnostics_descriptor descriptor(
+            left_str,
+            right_str,
+            stringify_range_window(left, std::next(begin(left), window_index), window_index, window_size, allocator),
+            stringify_range_window(right, std::next(begin(right), window_index), window_index, window_size, allocator),
+            has_multiple_formats()
+        );
+        if(left_size != right_size) {
+            descriptor.add_range_difference(bstringf("size: %zu vs %zu", left_size, right_size));
+        }
+        for(const auto& entry : differences) {
+            const stringification_budget_scope budget_scope(stringification_budget_scope::value);
+            std::string line = bstringf("[%zu]: ", entry.index);
+            do_stringify_into(line, *entry.left);
+            line += " vs ";
+            do_stringify_into(line, *entry.right);
+            descriptor.add_range_difference(line);
+        }
+        if(n_differences > differences.size()) {
+            descriptor.add_range_difference(
+                bstringf("... and %zu more differences", n_differences - differences.size())
+            );
+        }
+        return descriptor;
+    }
+
     template<typename A, typename B>
     LIBASSERT_ATTR_COLD [[nodiscard]]
     binary_diagnostics_descriptor generate_binary_diagnostic(
@@ -328,7 +677,8 @@ namespace libassert::detail {
         const B& right,
         std::string_view left_str,
         std::string_view right_str,
-        std::string_view op
+        std::string_view op,
+        const arena_allocator<char>& allocator
     ) {
         constexpr bool either_is_character = isa<A, char> || isa<B, char>;
         constexpr bool either_is_arithmetic = is_arith_not_bool_char<A> || is_arith_not_bool_char<B>;
@@ -338,11 +688,19 @@ namespace libassert::detail {
             op,
             either_is_character && either_is_arithmetic
         );
+        if constexpr(is_range_diffable<A, B>::value) {
+            if(op == "==") {
+                if(auto diff = generate_range_diff(left, right, left_str, right_str, allocator)) {
+                    restore_literal_format(previous_format);
+                    return std::move(*diff);
+                }
+            }
+        }
         binary_diagnostics_descriptor descriptor(
             left_str,
             right_str,
-            generate_stringification(left),
-            generate_stringification(right),
+            generate_stringification(left, allocator),
+            generate_stringification(right, allocator),
             has_multiple_formats()
         );
         restore_literal_format(previous_format);
@@ -355,9 +713,13 @@ namespace libassert::detail {
     #undef LIBASSERT_Y
     #undef LIBASSERT_X
 
-    struct pretty_function_name_wrapper {
-        const char* pretty_function;
-    };
+    // out of line so that code for the arena containers isn't instantiated in every translation unit
+    LIBASSERT_EXPORT void set_message(assertion_info& info, std::string_view message);
+    LIBASSERT_EXPORT void add_extra_diagnostic(
+        assertion_info& info,
+        std::string_view expression,
+        arena_string&& stringification
+    );
 
     inline void process_arg( // TODO: Don't inline
         assertion_info& info,
@@ -375,22 +737,26 @@ namespace libassert::detail {
     void process_arg(assertion_info& info, size_t i, sv_span args_strings, const T& t) {
         if constexpr(isa<T, strip<decltype(errno)>>) {
             if(args_strings.data[i] == errno_expansion) {
-                info.extra_diagnostics.push_back({ "errno", bstringf("%2d \"%s\"", t, strerror_wrapper(t).c_str()) });
+                add_extra_diagnostic(
+                    info,
+                    "errno",
+                    arena_string(bstringf("%2d \"%s\"", t, strerror_wrapper(t).c_str()), info.get_allocator())
+                );
                 return;
             }
         } else if constexpr(is_string_type<T>) {
             if(i == 0) {
                 if constexpr(std::is_pointer_v<T>) {
                     if(t == nullptr) {
-                        info.message = "(nullptr)";
+                        set_message(info, "(nullptr)");
                         return;
                     }
                 }
-                info.message = t;
+                set_message(info, t);
                 return;
             }
         }
-        info.extra_diagnostics.push_back({ args_strings.data[i], generate_stringification(t) });
+        add_extra_diagnostic(info, args_strings.data[i], generate_stringification(t, info.get_allocator()));
     }
 
     template<typename... Args>
@@ -407,7 +773,32 @@ namespace libassert::detail {
  */
 
 namespace libassert::detail {
-    LIBASSERT_EXPORT void fail(const assertion_info& info);
+    // info is moved to the background reporter if the failure is deferred
+    LIBASSERT_EXPORT void fail(assertion_info&& info);
+
+    /*
+     * Emergency reporting, used when the normal path can't allocate
+     */
+
+    inline const char* find_pretty_function(const char*, const pretty_function_name_wrapper& t) noexcept {
+        return t.pretty_function;
+    }
+
+    template<typename T>
+    const char* find_pretty_function(const char* found, const T&) noexcept {
+        return found;
+    }
+
+    // Writes the site, statement, whatever of info was built before the allocation failed, the operands of args if
+    // their diagnostics weren't built, and the raw trace addresses to stderr using only a static buffer and write(2),
+    // then aborts. Async-signal-safe. info may be nullptr.
+    [[noreturn]] LIBASSERT_EXPORT void emergency_fail(
+        const assert_static_parameters* params,
+        erased_arguments args,
+        const char* function,
+        std::size_t n_args,
+        const assertion_info* info
+    ) noexcept;
 
     template<typename A, typename B, typename C, typename... Args>
     LIBASSERT_ATTR_COLD LIBASSERT_ATTR_NOINLINE
@@ -418,41 +809,76 @@ namespace libassert::detail {
         // NOLINTNEXTLINE(cppcoreguidelines-missing-std-forward)
         Args&&... args
     ) {
-        const size_t sizeof_extra_diagnostics = sizeof...(args) - 1; // - 1 for pretty function signature
-        LIBASSERT_PRIMITIVE_DEBUG_ASSERT(sizeof...(args) <= params->args_strings.size);
-        assertion_info info(
-            params,
-            cpptrace::generate_raw_trace(),
-            sizeof_extra_diagnostics
-        );
-        // process_args fills in the message, extra_diagnostics, and pretty_function
-        process_args(info, params->args_strings, args...);
-        // generate binary diagnostics
-        if constexpr(is_nothing<C>) {
-            static_assert(is_nothing<B> && !is_nothing<A>);
-            if constexpr(isa<A, bool>) {
-                (void)decomposer; // suppress warning in msvc
-            } else {
-                info.binary_diagnostics = generate_binary_diagnostic(
-                    decomposer.a,
-                    true,
-                    params->expr_str,
-                    "true",
-                    "=="
-                );
+        // suppressed failures are only counted
+        if(should_suppress(params)) {
+            return;
+        }
+        // the report and everything it refers to come out of the thread's failure arena, if there is one
+        const failure_arena_scope arena_scope;
+        // only building the report is covered, exceptions from the failure handler propagate as usual
+        std::optional<assertion_info> info;
+        try {
+            const size_t sizeof_extra_diagnostics = sizeof...(args) - 1; // - 1 for pretty function signature
+            LIBASSERT_PRIMITIVE_DEBUG_ASSERT(sizeof...(args) <= params->args_strings.size);
+            info.emplace(params, sizeof_extra_diagnostics, arena_scope.arena());
+            {
+                // stringified values share the assertion's output budget, the failure handler isn't limited by it
+                const stringification_budget_scope budget_scope(stringification_budget_scope::assertion);
+                // process_args fills in the message, extra_diagnostics, and pretty_function
+                process_args(*info, params->args_strings, args...);
+                // generate binary diagnostics
+                if constexpr(is_nothing<C>) {
+                    static_assert(is_nothing<B> && !is_nothing<A>);
+                    if constexpr(isa<A, bool>) {
+                        (void)decomposer; // suppress warning in msvc
+                    } else {
+                        info->binary_diagnostics = generate_binary_diagnostic(
+                            decomposer.a,
+                            true,
+                            params->expr_str,
+                            "true",
+                            "==",
+                            info->get_allocator()
+                        );
+                    }
+                } else {
+                    if(params->decomposition.resolved) {
+                        // split was found at compile time
+                        info->binary_diagnostics = generate_binary_diagnostic(
+                            decomposer.a,
+                            decomposer.b,
+                            params->decomposition.left,
+                            params->decomposition.right,
+                            C::op_string,
+                            info->get_allocator()
+                        );
+                    } else {
+                        auto [left_expression, right_expression] = decompose_expression(params, C::op_string);
+                        info->binary_diagnostics = generate_binary_diagnostic(
+                            decomposer.a,
+                            decomposer.b,
+                            left_expression,
+                            right_expression,
+                            C::op_string,
+                            info->get_allocator()
+                        );
+                    }
+                }
             }
-        } else {
-            auto [left_expression, right_expression] = decompose_expression(params->expr_str, C::op_string);
-            info.binary_diagnostics = generate_binary_diagnostic(
-                decomposer.a,
-                decomposer.b,
-                left_expression,
-                right_expression,
-                C::op_string
+        } catch(const std::bad_alloc&) {
+            // reporting needs the heap, fall back to a path that doesn't. Only the operands are erased, extra arguments
+            // are only shown if they were already stringified.
+            const char* function = nullptr;
+            ((function = find_pretty_function(function, args)), ...);
+            emergency_fail(
+                params,
+                erase_assertion<emergency_stringification>(decomposer),
+                function,
+                sizeof...(args) - 1,
+                info ? &*info : nullptr
             );
         }
-        // send off
-        fail(info);
+        fail(std::move(*info));
     }
 
     template<typename... Args>
@@ -463,17 +889,23 @@ namespace libassert::detail {
         // NOLINTNEXTLINE(cppcoreguidelines-missing-std-forward)
         Args&&... args
     ) {
-        const size_t sizeof_extra_diagnostics = sizeof...(args) - 1; // - 1 for pretty function signature
-        LIBASSERT_PRIMITIVE_DEBUG_ASSERT(sizeof...(args) <= params->args_strings.size);
-        assertion_info info(
-            params,
-            cpptrace::generate_raw_trace(),
-            sizeof_extra_diagnostics
-        );
-        // process_args fills in the message, extra_diagnostics, and pretty_function
-        process_args(info, params->args_strings, args...);
-        // send off
-        fail(info);
+        const failure_arena_scope arena_scope;
+        std::optional<assertion_info> info;
+        try {
+            const size_t sizeof_extra_diagnostics = sizeof...(args) - 1; // - 1 for pretty function signature
+            LIBASSERT_PRIMITIVE_DEBUG_ASSERT(sizeof...(args) <= params->args_strings.size);
+            info.emplace(params, sizeof_extra_diagnostics, arena_scope.arena());
+            {
+                const stringification_budget_scope budget_scope(stringification_budget_scope::assertion);
+                // process_args fills in the message, extra_diagnostics, and pretty_function
+                process_args(*info, params->args_strings, args...);
+            }
+        } catch(const std::bad_alloc&) {
+            const char* function = nullptr;
+            ((function = find_pretty_function(function, args)), ...);
+            emergency_fail(params, erased_arguments{}, function, sizeof...(args) - 1, info ? &*info : nullptr);
+        }
+        fail(std::move(*info));
         LIBASSERT_PRIMITIVE_PANIC("PANIC/UNREACHABLE failure handler returned");
     }
 
@@ -499,499 +931,55 @@ namespace libassert::detail {
         process_assert_fail(decomposer, params, std::forward<Args>(args)...);
     }
 
-    template<typename T>
-    struct assert_value_wrapper {
-        T value;
-    };
+    /*
+     * Type-erased failure processing, see assert-core.hpp
+     */
 
-    template<
-        bool R, bool ret_lhs, bool value_is_lval_ref,
-        typename T, typename A, typename B, typename C
-    >
-    constexpr auto get_expression_return_value(T& value, expression_decomposer<A, B, C>& decomposer) {
-        if constexpr(R) {
-            if constexpr(ret_lhs) {
-                if constexpr(std::is_lvalue_reference_v<A>) {
-                    return assert_value_wrapper<A>{decomposer.take_lhs()};
-                } else {
-                    return assert_value_wrapper<A>{std::move(decomposer.take_lhs())};
-                }
+    // Stringification for the type-erased tables once the full stringification is available
+    struct full_stringification {
+        template<typename T>
+        LIBASSERT_ATTR_COLD static std::string stringify(const void* value) {
+            return generate_stringification(*static_cast<const T*>(value));
+        }
+
+        template<typename A, typename B>
+        LIBASSERT_ATTR_COLD static bool diff_ranges(
+            const void* left,
+            const void* right,
+            std::string_view left_expression,
+            std::string_view right_expression,
+            const arena_allocator<char>& allocator,
+            binary_diagnostics_descriptor& diagnostics
+        ) {
+            auto diff = generate_range_diff(
+                *static_cast<const A*>(left),
+                *static_cast<const B*>(right),
+                left_expression,
+                right_expression,
+                allocator
+            );
+            if(diff) {
+                diagnostics = std::move(*diff);
+            }
+            return diff.has_value();
+        }
+
+        template<typename A, typename B>
+        static constexpr erased_range_diff range_diff() {
+            if constexpr(is_range_diffable<A, B>::value) {
+                return diff_ranges<A, B>;
             } else {
-                if constexpr(value_is_lval_ref) {
-                    return assert_value_wrapper<T&>{value};
-                } else {
-                    return assert_value_wrapper<T>{std::move(value)};
-                }
+                return nullptr;
             }
         }
-    }
+    };
 }
 
 #if LIBASSERT_IS_MSVC
  #pragma warning(pop)
 #endif
 
-#if LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC || !LIBASSERT_NON_CONFORMANT_MSVC_PREPROCESSOR
- // Macro mapping utility by William Swanson https://github.com/swansontec/map-macro/blob/master/map.h
- #define LIBASSERT_EVAL0(...) __VA_ARGS__
- #define LIBASSERT_EVAL1(...) LIBASSERT_EVAL0(LIBASSERT_EVAL0(LIBASSERT_EVAL0(__VA_ARGS__)))
- #define LIBASSERT_EVAL2(...) LIBASSERT_EVAL1(LIBASSERT_EVAL1(LIBASSERT_EVAL1(__VA_ARGS__)))
- #define LIBASSERT_EVAL3(...) LIBASSERT_EVAL2(LIBASSERT_EVAL2(LIBASSERT_EVAL2(__VA_ARGS__)))
- #define LIBASSERT_EVAL4(...) LIBASSERT_EVAL3(LIBASSERT_EVAL3(LIBASSERT_EVAL3(__VA_ARGS__)))
- #define LIBASSERT_EVAL(...)  LIBASSERT_EVAL4(LIBASSERT_EVAL4(LIBASSERT_EVAL4(__VA_ARGS__)))
- #define LIBASSERT_MAP_END(...)
- #define LIBASSERT_MAP_OUT
- #define LIBASSERT_MAP_COMMA ,
- #define LIBASSERT_MAP_GET_END2() 0, LIBASSERT_MAP_END
- #define LIBASSERT_MAP_GET_END1(...) LIBASSERT_MAP_GET_END2
- #define LIBASSERT_MAP_GET_END(...) LIBASSERT_MAP_GET_END1
- #define LIBASSERT_MAP_NEXT0(test, next, ...) next LIBASSERT_MAP_OUT
- #define LIBASSERT_MAP_NEXT1(test, next) LIBASSERT_MAP_NEXT0(test, next, 0)
- #define LIBASSERT_MAP_NEXT(test, next)  LIBASSERT_MAP_NEXT1(LIBASSERT_MAP_GET_END test, next)
- #define LIBASSERT_MAP0(f, x, peek, ...) f(x) LIBASSERT_MAP_NEXT(peek, LIBASSERT_MAP1)(f, peek, __VA_ARGS__)
- #define LIBASSERT_MAP1(f, x, peek, ...) f(x) LIBASSERT_MAP_NEXT(peek, LIBASSERT_MAP0)(f, peek, __VA_ARGS__)
- #define LIBASSERT_MAP_LIST_NEXT1(test, next) LIBASSERT_MAP_NEXT0(test, LIBASSERT_MAP_COMMA next, 0)
- #define LIBASSERT_MAP_LIST_NEXT(test, next)  LIBASSERT_MAP_LIST_NEXT1(LIBASSERT_MAP_GET_END test, next)
- #define LIBASSERT_MAP_LIST0(f, x, peek, ...) \
-                                   f(x) LIBASSERT_MAP_LIST_NEXT(peek, LIBASSERT_MAP_LIST1)(f, peek, __VA_ARGS__)
- #define LIBASSERT_MAP_LIST1(f, x, peek, ...) \
-                                   f(x) LIBASSERT_MAP_LIST_NEXT(peek, LIBASSERT_MAP_LIST0)(f, peek, __VA_ARGS__)
- #define LIBASSERT_MAP(f, ...) LIBASSERT_EVAL(LIBASSERT_MAP1(f, __VA_ARGS__, ()()(), ()()(), ()()(), 0))
-#else
- // https://stackoverflow.com/a/29474124/15675011
- #define LIBASSERT_PLUS_TEXT_(x,y) x ## y
- #define LIBASSERT_PLUS_TEXT(x, y) LIBASSERT_PLUS_TEXT_(x, y)
- #define LIBASSERT_ARG_1(_1, ...) _1
- #define LIBASSERT_ARG_2(_1, _2, ...) _2
- #define LIBASSERT_ARG_3(_1, _2, _3, ...) _3
- #define LIBASSERT_ARG_40( _0, _1, _2, _3, _4, _5, _6, _7, _8, _9, \
-                 _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, \
-                 _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, \
-                 _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, \
-                 ...) _39
- #define LIBASSERT_OTHER_1(_1, ...) __VA_ARGS__
- #define LIBASSERT_OTHER_3(_1, _2, _3, ...) __VA_ARGS__
- #define LIBASSERT_EVAL0(...) __VA_ARGS__
- #define LIBASSERT_EVAL1(...) LIBASSERT_EVAL0(LIBASSERT_EVAL0(LIBASSERT_EVAL0(__VA_ARGS__)))
- #define LIBASSERT_EVAL2(...) LIBASSERT_EVAL1(LIBASSERT_EVAL1(LIBASSERT_EVAL1(__VA_ARGS__)))
- #define LIBASSERT_EVAL3(...) LIBASSERT_EVAL2(LIBASSERT_EVAL2(LIBASSERT_EVAL2(__VA_ARGS__)))
- #define LIBASSERT_EVAL4(...) LIBASSERT_EVAL3(LIBASSERT_EVAL3(LIBASSERT_EVAL3(__VA_ARGS__)))
- #define LIBASSERT_EVAL(...) LIBASSERT_EVAL4(LIBASSERT_EVAL4(LIBASSERT_EVAL4(__VA_ARGS__)))
- #define LIBASSERT_EXPAND(x) x
- #define LIBASSERT_MAP_SWITCH(...)\
-     LIBASSERT_EXPAND(LIBASSERT_ARG_40(__VA_ARGS__, 2, 2, 2, 2, 2, 2, 2, 2, 2,\
-             2, 2, 2, 2, 2, 2, 2, 2, 2, 2,\
-             2, 2, 2, 2, 2, 2, 2, 2, 2,\
-             2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0))
- #define LIBASSERT_MAP_A(...) LIBASSERT_PLUS_TEXT(LIBASSERT_MAP_NEXT_, \
-                                            LIBASSERT_MAP_SWITCH(0, __VA_ARGS__)) (LIBASSERT_MAP_B, __VA_ARGS__)
- #define LIBASSERT_MAP_B(...) LIBASSERT_PLUS_TEXT(LIBASSERT_MAP_NEXT_, \
-                                            LIBASSERT_MAP_SWITCH(0, __VA_ARGS__)) (LIBASSERT_MAP_A, __VA_ARGS__)
- #define LIBASSERT_MAP_CALL(fn, Value) LIBASSERT_EXPAND(fn(Value))
- #define LIBASSERT_MAP_OUT
- #define LIBASSERT_MAP_NEXT_2(...)\
-     LIBASSERT_MAP_CALL(LIBASSERT_EXPAND(LIBASSERT_ARG_2(__VA_ARGS__)), \
-     LIBASSERT_EXPAND(LIBASSERT_ARG_3(__VA_ARGS__))) \
-     LIBASSERT_EXPAND(LIBASSERT_ARG_1(__VA_ARGS__)) \
-     LIBASSERT_MAP_OUT \
-     (LIBASSERT_EXPAND(LIBASSERT_ARG_2(__VA_ARGS__)), LIBASSERT_EXPAND(LIBASSERT_OTHER_3(__VA_ARGS__)))
- #define LIBASSERT_MAP_NEXT_0(...)
- #define LIBASSERT_MAP(...)    LIBASSERT_EVAL(LIBASSERT_MAP_A(__VA_ARGS__))
-#endif
-
-#define LIBASSERT_STRINGIFY(x) #x,
-#define LIBASSERT_COMMA ,
-
-// Church boolean
-#define LIBASSERT_IF(b) LIBASSERT_IF_##b
-#define LIBASSERT_IF_true(t,...) t
-#define LIBASSERT_IF_false(t,f,...) f
-
-#if LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC
- #if LIBASSERT_IS_GCC
-  #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_GCC \
-     _Pragma("GCC diagnostic ignored \"-Wparentheses\"") \
-     _Pragma("GCC diagnostic ignored \"-Wuseless-cast\"") // #49
-  #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_CLANG
-  #define LIBASSERT_WARNING_PRAGMA_PUSH_GCC _Pragma("GCC diagnostic push")
-  #define LIBASSERT_WARNING_PRAGMA_POP_GCC _Pragma("GCC diagnostic pop")
-  #define LIBASSERT_WARNING_PRAGMA_PUSH_CLANG
-  #define LIBASSERT_WARNING_PRAGMA_POP_CLANG
- #else
-  #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_CLANG \
-     _Pragma("GCC diagnostic ignored \"-Wparentheses\"") \
-     _Pragma("GCC diagnostic ignored \"-Woverloaded-shift-op-parentheses\"")
-  #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_GCC
-  #define LIBASSERT_WARNING_PRAGMA_PUSH_GCC
-  #define LIBASSERT_WARNING_PRAGMA_POP_GCC
-  #define LIBASSERT_WARNING_PRAGMA_PUSH_CLANG _Pragma("GCC diagnostic push")
-  #define LIBASSERT_WARNING_PRAGMA_POP_CLANG _Pragma("GCC diagnostic pop")
- #endif
-#else
- #define LIBASSERT_WARNING_PRAGMA_PUSH_CLANG
- #define LIBASSERT_WARNING_PRAGMA_POP_CLANG
- #define LIBASSERT_WARNING_PRAGMA_PUSH_GCC
- #define LIBASSERT_WARNING_PRAGMA_POP_GCC
- #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_GCC
- #define LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_CLANG
-#endif
-
-namespace libassert {
-    inline void ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT() {
-        // This non-constexpr method is called from an assertion in a constexpr context if a failure occurs. It is
-        // intentionally a no-op.
-    }
-}
-
-// __PRETTY_FUNCTION__ used because __builtin_FUNCTION() used in source_location (like __FUNCTION__) is just the method
-// name, not signature
-// The arg strings at the very least must be static constexpr. Unfortunately static constexpr variables are not allowed
-// in constexpr functions pre-C++23.
-// TODO: Try to do a hybrid in C++20 with std::is_constant_evaluated?
-#if defined(__cpp_constexpr) && __cpp_constexpr >= 202211L
-// Can just use static constexpr everywhere
-#define LIBASSERT_STATIC_DATA(name, type, expr_str, ...) \
-    /* extra string here because of extra comma from map, also serves as terminator */ \
-    /* LIBASSERT_STRINGIFY LIBASSERT_VA_ARGS because msvc */ \
-    /* Trailing return type here to work around a gcc <= 9.2 bug */ \
-    /* Oddly only affecting builds under -DNDEBUG https://godbolt.org/z/5Treozc4q */ \
-    using libassert_params_t = libassert::detail::assert_static_parameters; \
-    /* NOLINTNEXTLINE(*-avoid-c-arrays) */ \
-    static constexpr std::string_view libassert_arg_strings[] = { \
-        LIBASSERT_MAP(LIBASSERT_STRINGIFY LIBASSERT_VA_ARGS(__VA_ARGS__)) "" \
-    }; \
-    static constexpr libassert_params_t _libassert_params = { \
-        name LIBASSERT_COMMA \
-        type LIBASSERT_COMMA \
-        expr_str LIBASSERT_COMMA \
-        {} LIBASSERT_COMMA \
-        {libassert_arg_strings, sizeof(libassert_arg_strings) / sizeof(std::string_view)} LIBASSERT_COMMA \
-    }; \
-    const libassert_params_t* libassert_params = &_libassert_params;
-#else
-#define LIBASSERT_STATIC_DATA(name, type, expr_str, ...) \
-    using libassert_params_t = libassert::detail::assert_static_parameters; \
-    /* NOLINTNEXTLINE(*-avoid-c-arrays) */ \
-    const libassert_params_t* libassert_params = []() -> const libassert_params_t* { \
-        static constexpr std::string_view libassert_arg_strings[] = { \
-            LIBASSERT_MAP(LIBASSERT_STRINGIFY LIBASSERT_VA_ARGS(__VA_ARGS__)) "" \
-        }; \
-        static constexpr libassert_params_t _libassert_params = { \
-            name LIBASSERT_COMMA \
-            type LIBASSERT_COMMA \
-            expr_str LIBASSERT_COMMA \
-            {} LIBASSERT_COMMA \
-            {libassert_arg_strings, sizeof(libassert_arg_strings) / sizeof(std::string_view)} LIBASSERT_COMMA \
-        }; \
-        return &_libassert_params; \
-    }();
-#endif
-
-// Note about statement expressions: These are needed for two reasons. The first is putting the arg string array and
-// source location structure in .rodata rather than on the stack, the second is a _Pragma for warnings which isn't
-// allowed in the middle of an expression by GCC. The semantics are similar to a function return:
-// Given M m; in parent scope, ({ m; }) is an rvalue M&& rather than an lvalue
-// ({ M m; m; }) doesn't move, it copies
-// ({ M{}; }) does move
-// Of relevance to this: in foo(__extension__ ({ M{1} + M{1}; })); the lifetimes of the M{1} objects end during the
-// statement expression but the lifetime of the returned object is extend to the end of the full foo() expression.
-// A wrapper struct is used here to return an lvalue reference from a gcc statement expression.
-// Note: There is a current issue with tarnaries: auto x = assert(b ? y : y); must copy y. This can be fixed with
-// lambdas but that's potentially very expensive compile-time wise. Need to investigate further.
-// Note: libassert::detail::expression_decomposer(libassert::detail::expression_decomposer{} << expr) done for ternary
-#if LIBASSERT_IS_MSVC
- #define LIBASSERT_INVOKE_VAL_PRETTY_FUNCTION_ARG ,libassert::detail::pretty_function_name_wrapper{libassert_msvc_pfunc}
-#else
- #define LIBASSERT_INVOKE_VAL_PRETTY_FUNCTION_ARG ,libassert::detail::pretty_function_name_wrapper{LIBASSERT_PFUNC}
-#endif
-#define LIBASSERT_PRETTY_FUNCTION_ARG ,libassert::detail::pretty_function_name_wrapper{LIBASSERT_PFUNC}
-#if LIBASSERT_IS_CLANG // -Wall in clang
- #define LIBASSERT_IGNORE_UNUSED_VALUE _Pragma("GCC diagnostic ignored \"-Wunused-value\"")
-#else
- #define LIBASSERT_IGNORE_UNUSED_VALUE
-#endif
-
-#define LIBASSERT_BREAKPOINT_IF_DEBUGGING() \
-    do \
-        if(libassert::is_debugger_present()) { \
-            LIBASSERT_BREAKPOINT(); \
-        } \
-    while(0)
-
-#ifdef LIBASSERT_BREAK_ON_FAIL
- #define LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL() LIBASSERT_BREAKPOINT_IF_DEBUGGING()
-#else
- #define LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL()
-#endif
-
-#define LIBASSERT_INVOKE(expr, name, type, failaction, ...) \
-    /* must push/pop out here due to nasty clang bug https://github.com/llvm/llvm-project/issues/63897 */ \
-    /* must do awful stuff to workaround differences in where gcc and clang allow these directives to go */ \
-    do { \
-        LIBASSERT_WARNING_PRAGMA_PUSH_CLANG \
-        LIBASSERT_IGNORE_UNUSED_VALUE \
-        LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_CLANG \
-        LIBASSERT_WARNING_PRAGMA_PUSH_GCC \
-        LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_GCC \
-        auto libassert_decomposer = libassert::detail::expression_decomposer( \
-            libassert::detail::expression_decomposer{} << expr \
-        ); \
-        LIBASSERT_WARNING_PRAGMA_POP_GCC \
-        if(LIBASSERT_STRONG_EXPECT(!static_cast<bool>(libassert_decomposer.get_value()), 0)) { \
-            libassert::ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT(); \
-            LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL(); \
-            failaction \
-            LIBASSERT_STATIC_DATA(name, libassert::assert_type::type, #expr, __VA_ARGS__) \
-            if constexpr(sizeof libassert_decomposer > 32) { \
-                libassert::detail::process_assert_fail( \
-                    libassert_decomposer, \
-                    libassert_params \
-                    LIBASSERT_VA_ARGS(__VA_ARGS__) LIBASSERT_PRETTY_FUNCTION_ARG \
-                ); \
-            } else { \
-                /* std::move it to assert_fail_m, will be moved back to r */ \
-                libassert::detail::process_assert_fail_n( \
-                    std::move(libassert_decomposer), \
-                    libassert_params \
-                    LIBASSERT_VA_ARGS(__VA_ARGS__) LIBASSERT_PRETTY_FUNCTION_ARG \
-                ); \
-            } \
-        } \
-        LIBASSERT_WARNING_PRAGMA_POP_CLANG \
-    } while(false) \
-
-#define LIBASSERT_INVOKE_PANIC(name, type, ...) \
-    do { \
-        libassert::ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT(); \
-        LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL(); \
-        LIBASSERT_STATIC_DATA(name, libassert::assert_type::type, "", __VA_ARGS__) \
-        libassert::detail::process_panic( \
-            libassert_params \
-            LIBASSERT_VA_ARGS(__VA_ARGS__) LIBASSERT_PRETTY_FUNCTION_ARG \
-        ); \
-    } while(false) \
-
-// Workaround for gcc bug 105734 / libassert bug #24
-#define LIBASSERT_DESTROY_DECOMPOSER libassert_decomposer.~expression_decomposer() /* NOLINT(bugprone-use-after-move,clang-analyzer-cplusplus.Move) */
-#if LIBASSERT_IS_GCC
- #if __GNUC__ == 12 && __GNUC_MINOR__ == 1
-  namespace libassert::detail {
-      template<typename T> constexpr void destroy(T& t) {
-          t.~T();
-      }
-  }
-  #undef LIBASSERT_DESTROY_DECOMPOSER
-  #define LIBASSERT_DESTROY_DECOMPOSER libassert::detail::destroy(libassert_decomposer)
- #endif
-#endif
-#if LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC
- // Extra set of parentheses here because clang treats __extension__ as a low-precedence unary operator which interferes
- // with decltype(auto) in an expression like decltype(auto) x = __extension__ ({...}).y;
- #define LIBASSERT_STMTEXPR(B, R) (__extension__ ({ B R }))
- #define LIBASSERT_STATIC_CAST_TO_BOOL(x) static_cast<bool>(x)
-#else
- #define LIBASSERT_STMTEXPR(B, R) [&](const char* libassert_msvc_pfunc) { B return R }(LIBASSERT_PFUNC)
- // Workaround for msvc bug
- #define LIBASSERT_STATIC_CAST_TO_BOOL(x) libassert::detail::static_cast_to_bool(x)
- namespace libassert::detail {
-     template<typename T> constexpr bool static_cast_to_bool(T&& t) {
-         return static_cast<bool>(t);
-     }
- }
-#endif
-#define LIBASSERT_INVOKE_VAL(expr, doreturn, check_expression, name, type, failaction, ...) \
-    /* must push/pop out here due to nasty clang bug https://github.com/llvm/llvm-project/issues/63897 */ \
-    /* must do awful stuff to workaround differences in where gcc and clang allow these directives to go */ \
-    LIBASSERT_WARNING_PRAGMA_PUSH_CLANG \
-    LIBASSERT_IGNORE_UNUSED_VALUE \
-    LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_CLANG \
-    LIBASSERT_STMTEXPR( \
-        LIBASSERT_WARNING_PRAGMA_PUSH_GCC \
-        LIBASSERT_EXPRESSION_DECOMP_WARNING_PRAGMA_GCC \
-        auto libassert_decomposer = libassert::detail::expression_decomposer( \
-            libassert::detail::expression_decomposer{} << expr \
-        ); \
-        LIBASSERT_WARNING_PRAGMA_POP_GCC \
-        decltype(auto) libassert_value = libassert_decomposer.get_value(); \
-        constexpr bool libassert_ret_lhs = libassert_decomposer.ret_lhs(); \
-        if constexpr(check_expression) { \
-            /* For *some* godforsaken reason static_cast<bool> causes an ICE in MSVC here. Something very specific */ \
-            /* about casting a decltype(auto) value inside a lambda. Workaround is to put it in a wrapper. */ \
-            /* https://godbolt.org/z/Kq8Wb6q5j https://godbolt.org/z/nMnqnsMYx */ \
-            if(LIBASSERT_STRONG_EXPECT(!LIBASSERT_STATIC_CAST_TO_BOOL(libassert_value), 0)) { \
-                libassert::ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT(); \
-                LIBASSERT_BREAKPOINT_IF_DEBUGGING_ON_FAIL(); \
-                failaction \
-                LIBASSERT_STATIC_DATA(name, libassert::assert_type::type, #expr, __VA_ARGS__) \
-                if constexpr(sizeof libassert_decomposer > 32) { \
-                    libassert::detail::process_assert_fail( \
-                        libassert_decomposer, \
-                        libassert_params \
-                        LIBASSERT_VA_ARGS(__VA_ARGS__) LIBASSERT_INVOKE_VAL_PRETTY_FUNCTION_ARG \
-                    ); \
-                } else { \
-                    /* std::move it to assert_fail_m, will be moved back to r */ \
-                    auto libassert_r = libassert::detail::process_assert_fail_m( \
-                        std::move(libassert_decomposer), \
-                        libassert_params \
-                        LIBASSERT_VA_ARGS(__VA_ARGS__) LIBASSERT_INVOKE_VAL_PRETTY_FUNCTION_ARG \
-                    ); \
-                    /* can't move-assign back to decomposer if it holds reference members */ \
-                    LIBASSERT_DESTROY_DECOMPOSER; \
-                    new (&libassert_decomposer) libassert::detail::expression_decomposer(std::move(libassert_r)); \
-                } \
-            } \
-        }, \
-        /* Note: std::launder needed in 17 in case of placement new / move shenanigans above */ \
-        /* https://timsong-cpp.github.io/cppwp/n4659/basic.life#8.3 */ \
-        /* Note: Somewhat relying on this call being inlined so inefficiency is eliminated */ \
-        libassert::detail::get_expression_return_value< \
-            doreturn LIBASSERT_COMMA \
-            libassert_ret_lhs LIBASSERT_COMMA \
-            std::is_lvalue_reference_v<decltype(libassert_value)> \
-        >(libassert_value, *std::launder(&libassert_decomposer)); \
-    ) LIBASSERT_IF(doreturn)(.value,) \
-    LIBASSERT_WARNING_PRAGMA_POP_CLANG
-
-#ifdef NDEBUG
- #define LIBASSERT_ASSUME_ACTION LIBASSERT_UNREACHABLE_CALL;
-#else
- #define LIBASSERT_ASSUME_ACTION
-#endif
-
-// assertion macros
-
-// Debug assert
-#ifndef NDEBUG
- #define LIBASSERT_DEBUG_ASSERT(expr, ...) LIBASSERT_INVOKE(expr, "DEBUG_ASSERT", debug_assertion, , __VA_ARGS__)
-#else
- #define LIBASSERT_DEBUG_ASSERT(expr, ...) (void)0
-#endif
-
-// Assert
-#define LIBASSERT_ASSERT(expr, ...) LIBASSERT_INVOKE(expr, "ASSERT", assertion, , __VA_ARGS__)
-// lowercase version intentionally done outside of the include guard here
-
-// Assume
-#define LIBASSERT_ASSUME(expr, ...) LIBASSERT_INVOKE(expr, "ASSUME", assumption, LIBASSERT_ASSUME_ACTION, __VA_ARGS__)
-
-// Panic
-#define LIBASSERT_PANIC(...) LIBASSERT_INVOKE_PANIC("PANIC", panic, __VA_ARGS__)
-
-// Unreachable
-#ifndef NDEBUG
- #define LIBASSERT_UNREACHABLE(...) LIBASSERT_INVOKE_PANIC("UNREACHABLE", unreachable, __VA_ARGS__)
-#else
- #define LIBASSERT_UNREACHABLE(...) LIBASSERT_UNREACHABLE_CALL
-#endif
-
-// value variants
-
-#ifndef NDEBUG
- #define LIBASSERT_DEBUG_ASSERT_VAL(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, true, "DEBUG_ASSERT_VAL", debug_assertion, , __VA_ARGS__)
-#else
- #define LIBASSERT_DEBUG_ASSERT_VAL(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, false, "DEBUG_ASSERT_VAL", debug_assertion, , __VA_ARGS__)
-#endif
-
-#define LIBASSERT_ASSUME_VAL(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, true, "ASSUME_VAL", assumption, LIBASSERT_ASSUME_ACTION, __VA_ARGS__)
-
-#define LIBASSERT_ASSERT_VAL(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, true, "ASSERT_VAL", assertion, , __VA_ARGS__)
-
-// non-prefixed versions
-
-#ifndef LIBASSERT_PREFIX_ASSERTIONS
- #if LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC || !LIBASSERT_NON_CONFORMANT_MSVC_PREPROCESSOR
-  #define DEBUG_ASSERT(...) LIBASSERT_DEBUG_ASSERT(__VA_ARGS__)
-  #define ASSERT(...) LIBASSERT_ASSERT(__VA_ARGS__)
-  #define ASSUME(...) LIBASSERT_ASSUME(__VA_ARGS__)
-  #define PANIC(...) LIBASSERT_PANIC(__VA_ARGS__)
-  #define UNREACHABLE(...) LIBASSERT_UNREACHABLE(__VA_ARGS__)
-  #define DEBUG_ASSERT_VAL(...) LIBASSERT_DEBUG_ASSERT_VAL(__VA_ARGS__)
-  #define ASSUME_VAL(...) LIBASSERT_ASSUME_VAL(__VA_ARGS__)
-  #define ASSERT_VAL(...) LIBASSERT_ASSERT_VAL(__VA_ARGS__)
- #else
-  // because of course msvc
-  #define DEBUG_ASSERT LIBASSERT_DEBUG_ASSERT
-  #define ASSERT LIBASSERT_ASSERT
-  #define ASSUME LIBASSERT_ASSUME
-  #define PANIC LIBASSERT_PANIC
-  #define UNREACHABLE LIBASSERT_UNREACHABLE
-  #define DEBUG_ASSERT_VAL LIBASSERT_DEBUG_ASSERT_VAL
-  #define ASSUME_VAL LIBASSERT_ASSUME_VAL
-  #define ASSERT_VAL LIBASSERT_ASSERT_VAL
- #endif
-#endif
-
-// Lowercase variants
-
-#ifdef LIBASSERT_LOWERCASE
- #ifndef NDEBUG
-  #define debug_assert(expr, ...) LIBASSERT_INVOKE(expr, "debug_assert", debug_assertion, , __VA_ARGS__)
- #else
-  #define debug_assert(expr, ...) (void)0
- #endif
-#endif
-
-#ifdef LIBASSERT_LOWERCASE
- #ifndef NDEBUG
-  #define debug_assert_val(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, true, "debug_assert_val", debug_assertion, , __VA_ARGS__)
- #else
-  #define debug_assert_val(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, false, "debug_assert_val", debug_assertion, , __VA_ARGS__)
- #endif
-#endif
-
-#ifdef LIBASSERT_LOWERCASE
- #define assert_val(expr, ...) LIBASSERT_INVOKE_VAL(expr, true, true, "assert_val", assertion, , __VA_ARGS__)
-#endif
-
-// Wrapper macro to allow support for C++26's user generated static_assert messages.
-// The backup message version also allows for the user to provide a backup version that will
-// be used if the compiler does not support user generated messages.
-// More info on user generated static_assert's
-// can be found here: https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2023/p2741r1.pdf
-//
-// Currently the functionality works as such. If we are in a C++26 environment, the user generated message will be used.
-// If we are not in a C++26 environment, then either the static_assert will be used without a message or the backup message.
-// TODO: Maybe give these a better name? Ideally one that is shorter and more descriptive?
-// TODO: Maybe add a helper to make passing user generated static_assert messages easier?
-#if defined(__cpp_static_assert) && __cpp_static_assert >= 202306L
- #ifdef LIBASSERT_LOWERCASE
-  #define libassert_user_static_assert(cond, constant) static_assert(cond, constant)
-  #define libassert_user_static_assert_backup_msg(cond, msg, constant) static_assert(cond, constant)
-  #define user_static_assert(cond, constant) static_assert(cond, constant)
-  #define user_static_assert_backup_msg(cond, msg, constant) static_assert(cond, constant)
- #else
-  #define LIBASSERT_USER_STATIC_ASSERT(cond, constant) static_assert(cond, constant)
-  #define LIBASSERT_USER_STATIC_ASSERT_BACKUP_MSG(cond, msg, constant) static_assert(cond, constant)
-  #define USER_STATIC_ASSERT(cond, constant) static_assert(cond, constant)
-  #define USER_STATIC_ASSERT_BACKUP_MSG(cond, msg, constant) static_assert(cond, constant)
- #endif
-#else
- #ifdef LIBASSERT_LOWERCASE
-  #define libassert_user_static_assert(cond, constant) static_assert(cond)
-  #define libassert_user_static_assert_backup_msg(cond, msg, constant) static_assert(cond, msg)
-  #define user_static_assert(cond, constant) static_assert(cond)
-  #define user_static_assert_backup_msg(cond, msg, constant) static_assert(cond, msg)
- #else
-  #define LIBASSERT_USER_STATIC_ASSERT(cond, constant) static_assert(cond)
-  #define LIBASSERT_USER_STATIC_ASSERT_BACKUP_MSG(cond, msg, constant) static_assert(cond, msg)
-  #define USER_STATIC_ASSERT(cond, constant) static_assert(cond)
-  #define USER_STATIC_ASSERT_BACKUP_MSG(cond, msg, constant) static_assert(cond, msg)
- #endif
-#endif
-
-
 #endif // LIBASSERT_HPP
 
-// Intentionally done outside the include guard. Libc++ leaks `assert` (among other things), so the include for
-// assert.hpp should go after other includes when using -DLIBASSERT_LOWERCASE.
-#ifdef LIBASSERT_LOWERCASE
- #ifdef assert
-  #undef assert
- #endif
- #ifndef NDEBUG
-  #define assert(expr, ...) LIBASSERT_INVOKE(expr, "assert", assertion, , __VA_ARGS__)
- #else
-  #define assert(expr, ...) LIBASSERT_INVOKE(expr, "assert", assertion, , __VA_ARGS__)
- #endif
-#endif
+// Intentionally done outside the include guard, see assert-macros.hpp
+#include <libassert/assert-macros.hpp>
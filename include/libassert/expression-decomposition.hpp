@@ -1,6 +1,8 @@
 #ifndef LIBASSERT_EXPRESSION_DECOMPOSITION_HPP
 #define LIBASSERT_EXPRESSION_DECOMPOSITION_HPP
 
+#include <cstddef>
+#include <initializer_list>
 #include <string_view>
 #include <type_traits>
 #include <utility>
@@ -325,6 +327,207 @@ namespace libassert::detail {
     expression_decomposer(U&&) -> expression_decomposer<
         std::conditional_t<std::is_rvalue_reference_v<U>, std::remove_reference_t<U>, U>
     >;
+
+    template<typename D> struct decomposer_op_string {
+        static constexpr std::string_view value = {};
+    };
+    template<typename A, typename B, typename C> struct decomposer_op_string<expression_decomposer<A, B, C>> {
+        static constexpr std::string_view value = [] {
+            if constexpr(is_nothing<C>) {
+                return std::string_view{};
+            } else {
+                return C::op_string;
+            }
+        }();
+    };
+
+    /*
+     * Compile-time expression splitting
+     */
+
+    // Left and right expression strings for a binary assertion. resolved is false if the split couldn't be determined
+    // at compile time, in which case decompose_expression is used at runtime.
+    struct static_decomposition {
+        std::string_view left;
+        std::string_view right;
+        bool resolved = false;
+    };
+
+    // A small constexpr scanner for the common case: the target operator appears exactly once outside of any
+    // brackets. Anything that needs real disambiguation (template angle brackets, alternative tokens, raw strings,
+    // operators with lower precedence than the decomposed one) is left to the runtime analysis.
+    class static_decomposer {
+        std::string_view source;
+        std::string_view target_op;
+        std::size_t i = 0;
+
+        static constexpr bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+        static constexpr bool is_identifier_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit(c) || c == '_' || c == '$';
+        }
+        static constexpr bool is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        }
+        static constexpr bool is_one_of(std::string_view str, std::initializer_list<std::string_view> list) {
+            for(auto item : list) {
+                if(str == item) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        static constexpr std::string_view trim(std::string_view str) {
+            while(!str.empty() && is_space(str.front())) {
+                str.remove_prefix(1);
+            }
+            while(!str.empty() && is_space(str.back())) {
+                str.remove_suffix(1);
+            }
+            return str;
+        }
+        constexpr char peek(std::size_t offset = 0) const {
+            return i + offset < source.size() ? source[i + offset] : '\0';
+        }
+        // reads a string or char literal starting at the opening quote, returns false if it's unterminated
+        constexpr bool read_quoted() {
+            const char quote = source[i++];
+            while(i < source.size() && source[i] != quote) {
+                if(source[i] == '\n') {
+                    return false;
+                }
+                i += source[i] == '\\' ? 2 : 1;
+            }
+            if(i >= source.size()) {
+                return false;
+            }
+            i++;
+            return true;
+        }
+        // maximal munch for the punctuators that matter here, everything else is a single character
+        constexpr std::string_view read_punctuator() {
+            constexpr std::string_view punctuators[] = {
+                "<<=", ">>=", "<=>", "->*", "...",
+                "::", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+                "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", ".*", "##"
+            };
+            for(auto punctuator : punctuators) {
+                if(source.substr(i, punctuator.size()) == punctuator) {
+                    i += punctuator.size();
+                    return punctuator;
+                }
+            }
+            return source.substr(i++, 1);
+        }
+    public:
+        constexpr static_decomposer(std::string_view source_, std::string_view target_op_)
+            : source(source_), target_op(target_op_) {}
+
+        // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+        constexpr static_decomposition decompose() {
+            if(target_op.empty()) {
+                return {};
+            }
+            int depth = 0;
+            int matches = 0;
+            std::size_t split = 0;
+            while(i < source.size()) {
+                const char c = source[i];
+                if(is_space(c)) {
+                    i++;
+                } else if(is_digit(c) || (c == '.' && is_digit(peek(1)))) {
+                    // pp-number, covers digit separators and exponent signs
+                    i++;
+                    while(i < source.size()) {
+                        if(
+                            (source[i] == '+' || source[i] == '-')
+                            && (source[i - 1] == 'e' || source[i - 1] == 'E'
+                                || source[i - 1] == 'p' || source[i - 1] == 'P')
+                        ) {
+                            i++;
+                        } else if(source[i] == '\'' && is_identifier_char(peek(1))) {
+                            i += 2;
+                        } else if(is_identifier_char(source[i]) || source[i] == '.') {
+                            i++;
+                        } else {
+                            break;
+                        }
+                    }
+                } else if(is_identifier_char(c)) {
+                    const std::size_t begin = i;
+                    while(i < source.size() && is_identifier_char(source[i])) {
+                        i++;
+                    }
+                    const auto identifier = source.substr(begin, i - begin);
+                    if(
+                        is_one_of(
+                            identifier,
+                            {
+                                "and", "or", "not", "xor", "bitand", "bitor", "compl",
+                                "and_eq", "or_eq", "xor_eq", "not_eq"
+                            }
+                        )
+                    ) {
+                        return {};
+                    }
+                    if(peek() == '"' || peek() == '\'') {
+                        // encoding prefixes, raw strings aren't handled
+                        if(!is_one_of(identifier, {"u8", "u", "U", "L"}) || !read_quoted()) {
+                            return {};
+                        }
+                    }
+                } else if(c == '"' || c == '\'') {
+                    if(!read_quoted()) {
+                        return {};
+                    }
+                } else {
+                    const std::size_t begin = i;
+                    const auto punctuator = read_punctuator();
+                    if(punctuator == "(" || punctuator == "[" || punctuator == "{") {
+                        depth++;
+                    } else if(punctuator == ")" || punctuator == "]" || punctuator == "}") {
+                        if(--depth < 0) {
+                            return {};
+                        }
+                    } else if(depth == 0 && punctuator == target_op) {
+                        matches++;
+                        split = begin;
+                    } else if(
+                        punctuator != "->" && punctuator != "->*"
+                        && (punctuator.find('<') != std::string_view::npos
+                            || punctuator.find('>') != std::string_view::npos)
+                    ) {
+                        // could be a template argument list
+                        return {};
+                    } else if(
+                        depth == 0
+                        && is_one_of(
+                            punctuator,
+                            {
+                                "?", ",", "=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>="
+                            }
+                        )
+                    ) {
+                        return {};
+                    }
+                }
+            }
+            if(depth != 0 || matches != 1) {
+                return {};
+            }
+            const auto left = trim(source.substr(0, split));
+            const auto right = trim(source.substr(split + target_op.size()));
+            if(left.empty() || right.empty()) {
+                return {};
+            }
+            return {left, right, true};
+        }
+    };
+
+    constexpr static_decomposition decompose_expression_static(std::string_view expression, std::string_view target_op) {
+        return static_decomposer(expression, target_op).decompose();
+    }
 }
 
 #endif
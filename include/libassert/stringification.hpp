@@ -1,10 +1,17 @@
 #ifndef LIBASSERT_STRINGIFICATION_HPP
 #define LIBASSERT_STRINGIFICATION_HPP
 
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <optional>
+#include <ostream>
+#include <streambuf>
 #include <string>
 #include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <libassert/platform.hpp>
 #include <libassert/utilities.hpp>
@@ -30,18 +37,17 @@
  #include <compare>
 #endif
 
+// only for the precompiled stringification list below
+#if defined(LIBASSERT_PRECOMPILED_STRINGIFICATION) || defined(LIBASSERT_INSTANTIATE_PRECOMPILED_STRINGIFICATION)
+ #include <map>
+ #include <unordered_map>
+#endif
+
 // =====================================================================================================================
 // || Stringification micro-library                                                                                   ||
 // || Note: There is some stateful stuff behind the scenes related to literal format configuration                    ||
 // =====================================================================================================================
 
-namespace libassert {
-    // customization point
-    template<typename T> struct stringifier /*{
-        std::convertible_to<std::string> stringify(const T&);
-    }*/;
-}
-
 namespace libassert::detail {
     // What can be stringified
     // Base types:
@@ -85,6 +91,11 @@ namespace libassert::detail {
     LIBASSERT_ATTR_COLD [[nodiscard]]
     std::string do_stringify(const T& v);
 
+    // Returns true if the value didn't fit in the output budget and was replaced by the elision marker
+    template<typename T>
+    LIBASSERT_ATTR_COLD
+    bool do_stringify_into(std::string& out, const T& v);
+
     namespace stringification {
         //
         // General traits
@@ -136,41 +147,9 @@ namespace libassert::detail {
             std::void_t<decltype(std::declval<std::ostream>() << std::declval<T>())>
         > : public std::true_type {};
 
-        template<typename T, typename = void> class has_stringifier : public std::false_type {};
-        template<typename T>
-        class has_stringifier<
-            T,
-            std::void_t<decltype(stringifier<strip<T>>{}.stringify(std::declval<T>()))>
-        > : public std::true_type {};
-
         //
-        // Catch all
+        // Basic types, the rest are in utilities.hpp
         //
-
-        template<typename T>
-        [[nodiscard]] std::string stringify_unknown() {
-            return bstringf("<instance of %s>", prettify_type(std::string(type_name<T>())).c_str());
-        }
-
-        //
-        // Basic types
-        //
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::string_view);
-        // without nullptr_t overload msvc (without /permissive-) will call stringify(bool) and mingw
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::nullptr_t);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(char);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(bool);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(short);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(int);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long long);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned short);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned int);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned long);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned long long);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(float);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(double);
-        [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long double);
         [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::error_code ec);
         [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::error_condition ec);
         [[nodiscard]] LIBASSERT_EXPORT std::string stringify(const std::filesystem::path& path);
@@ -179,27 +158,53 @@ namespace libassert::detail {
         [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::weak_ordering);
         [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::partial_ordering);
         #endif
-        [[nodiscard]] LIBASSERT_EXPORT
-        std::string stringify_pointer_value(const void*);
 
         template<typename T>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify_smart_ptr(const T& t) {
+        LIBASSERT_ATTR_COLD
+        bool stringify_smart_ptr_into(std::string& out, const T& t) {
             if(t) {
-                return do_stringify(*t);
+                return do_stringify_into(out, *t);
             } else {
-                return "nullptr";
+                out += "nullptr";
+                return false;
             }
         }
 
+        // Lets operator<< write straight into the output instead of going through an ostringstream's own buffer. Once
+        // the output is past the stringification budget nothing more is taken, the stream fails and skips the rest.
+        class string_appender_streambuf : public std::streambuf {
+            std::string& out;
+            std::size_t room;
+        protected:
+            int_type overflow(int_type c) override {
+                if(traits_type::eq_int_type(c, traits_type::eof())) {
+                    return traits_type::not_eof(c);
+                }
+                if(room == 0) {
+                    return traits_type::eof();
+                }
+                out += traits_type::to_char_type(c);
+                room--;
+                return c;
+            }
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+                const std::size_t count = std::min(static_cast<std::size_t>(n), room);
+                out.append(s, count);
+                room -= count;
+                return static_cast<std::streamsize>(count);
+            }
+        public:
+            explicit string_appender_streambuf(std::string& str) : out(str), room(stringification_output_limit()) {}
+        };
+
         template<typename T>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify_by_ostream(const T& t) {
+        LIBASSERT_ATTR_COLD
+        void stringify_by_ostream_into(std::string& out, const T& t) {
+            string_appender_streambuf buffer(out);
             // clang-tidy bug here
             // NOLINTNEXTLINE(misc-const-correctness)
-            std::ostringstream oss;
-            oss<<t;
-            return std::move(oss).str();
+            std::ostream stream(&buffer);
+            stream<<t;
         }
 
         #ifdef LIBASSERT_USE_MAGIC_ENUM
@@ -250,50 +255,75 @@ namespace libassert::detail {
         // }
         // #endif
 
+        // Compositions are rendered into the caller's buffer so nested values don't each build their own string. Each
+        // element is checked for having been elided, once the output budget runs out the rest of a composition is cut.
         template<typename T>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify(const std::optional<T>& t) {
+        LIBASSERT_ATTR_COLD
+        bool stringify_optional_into(std::string& out, const std::optional<T>& t) {
             if(t) {
-                return do_stringify(t.value());
+                return do_stringify_into(out, t.value());
             } else {
-                return "nullopt";
+                out += "nullopt";
+                return false;
             }
         }
 
+        template<typename T>
+        LIBASSERT_ATTR_COLD [[nodiscard]]
+        std::string stringify(const std::optional<T>& t) {
+            std::string str;
+            stringify_optional_into(str, t);
+            return str;
+        }
+
         inline constexpr std::size_t max_container_print_items = 1000;
 
         template<typename T>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify_container(const T& container) {
+        LIBASSERT_ATTR_COLD
+        void stringify_container_into(std::string& out, const T& container) {
             using std::begin, std::end; // ADL
-            std::string str = "[";
+            out += '[';
             const auto begin_it = begin(container);
             std::size_t count = 0;
             for(auto it = begin_it; it != end(container); it++) {
                 if(it != begin_it) {
-                    str += ", ";
+                    out += ", ";
                 }
-                str += do_stringify(*it);
+                if(do_stringify_into(out, *it)) {
+                    break; // the element didn't fit in the output budget, neither will the rest
+                }
+                charge_stringification_budget(2);
                 if(++count == max_container_print_items) {
-                    str += ", ...";
+                    out += ", ...";
                     break;
                 }
             }
-            str += "]";
-            return str;
+            out += ']';
         }
 
-        // I'm going to assume at least one index because is_tuple_like requires index 0 to exist
         template<typename T, size_t... I>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify_tuple_like_impl(const T& t, std::index_sequence<I...>) {
-            return "[" + (do_stringify(std::get<0>(t)) + ... + (", " + do_stringify(std::get<I + 1>(t)))) + "]";
+        LIBASSERT_ATTR_COLD
+        void stringify_tuple_like_into_impl(std::string& out, const T& t, std::index_sequence<I...>) {
+            out += '[';
+            bool elided = false;
+            const auto append = [&](const auto& element, std::size_t i) {
+                if(elided) {
+                    return;
+                }
+                if(i != 0) {
+                    out += ", ";
+                }
+                elided = do_stringify_into(out, element);
+                charge_stringification_budget(2);
+            };
+            (append(std::get<I>(t), I), ...);
+            out += ']';
         }
 
         template<typename T>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        std::string stringify_tuple_like(const T& t) {
-            return stringify_tuple_like_impl(t, std::make_index_sequence<std::tuple_size<T>::value - 1>{});
+        LIBASSERT_ATTR_COLD
+        void stringify_tuple_like_into(std::string& out, const T& t) {
+            stringify_tuple_like_into_impl(out, t, std::make_index_sequence<std::tuple_size<T>::value>{});
         }
     }
 
@@ -403,15 +433,54 @@ namespace libassert::detail {
         }
     };
 
+    // Appends a stringified leaf value, taking over its buffer when it's all of the output so far
+    inline void append_stringification(std::string& out, std::string&& str) {
+        if(out.empty()) {
+            out = std::move(str);
+        } else {
+            out += str;
+        }
+    }
+
+    // Whether stringifying a T can come back around to stringifying a T. Builtin leaves can't, everything else (user
+    // stringifiers, operator<<, compositions) gets a recursion guard.
     template<typename T>
-    LIBASSERT_ATTR_COLD [[nodiscard]]
-    std::string do_stringify(const T& v) {
-        // TODO: This is overkill to do for every instantiation of do_stringify (e.g. primitive types could omit this)
-        thread_local recursion_flag flag;
-        if(flag.test()) { // pathological case detected, fall back to unknown
-            return stringification::stringify_unknown<T>();
+    inline constexpr bool may_recurse = stringification::has_stringifier<T>::value || !(
+        std::is_same_v<T, std::nullptr_t>
+        || std::is_convertible_v<T, std::string_view>
+        || std::is_pointer_v<T>
+        || std::is_function_v<T>
+        || std::is_enum_v<T>
+        || std::is_arithmetic_v<T>
+    );
+
+    template<typename T>
+    bool stringify_value_into(std::string& out, const T& v);
+
+    template<typename T>
+    LIBASSERT_ATTR_COLD
+    bool do_stringify_into(std::string& out, const T& v) {
+        if(stringification_budget_remaining() == 0) {
+            out += elision_marker;
+            return true;
         }
-        auto canary = flag.set();
+        if constexpr(may_recurse<T>) {
+            thread_local recursion_flag flag;
+            if(flag.test()) { // pathological case detected, fall back to unknown
+                const std::size_t start = out.size();
+                append_stringification(out, stringification::stringify_unknown<T>());
+                return fit_stringification_budget(out, start);
+            }
+            auto canary = flag.set();
+            return stringify_value_into(out, v);
+        } else {
+            return stringify_value_into(out, v);
+        }
+    }
+
+    template<typename T>
+    bool stringify_value_into(std::string& out, const T& v) {
+        const std::size_t start = out.size();
         // Ordering notes
         // - stringifier first
         // - nullptr before string_view (char*)
@@ -419,90 +488,219 @@ namespace libassert::detail {
         // - enum before basic stringify
         // - container before basic stringify (c arrays and decay etc)
         //   - needs to exclude std::filesystem::path
+        // Leaf values are appended and then charged to the output budget at the end, compositions return early and are
+        // charged through their elements. A cut off composition isn't elided as a whole.
         if constexpr(stringification::has_stringifier<T>::value) {
-            return stringifier<strip<T>>{}.stringify(v);
+            append_stringification(out, std::string(stringifier<strip<T>>{}.stringify(v)));
         } else if constexpr(std::is_same_v<T, std::nullptr_t>) {
-            return "nullptr";
+            out += "nullptr";
         } else if constexpr(std::is_convertible_v<T, std::string_view>) {
             if constexpr(std::is_pointer_v<T>) {
                 if(v == nullptr) {
-                    return "nullptr";
+                    out += "nullptr";
+                    return fit_stringification_budget(out, start);
                 }
             }
             #if LIBASSERT_IS_GCC
                 #pragma GCC diagnostic push
                 #pragma GCC diagnostic ignored "-Wnonnull"
             #endif
-            return stringification::stringify(std::string_view(v));
+            stringification::stringify_into(out, std::string_view(v));
             #if LIBASSERT_IS_GCC
                 #pragma GCC diagnostic pop
             #endif
         } else if constexpr(std::is_pointer_v<T> || std::is_function_v<T>) {
-            return stringification::stringify_pointer_value(reinterpret_cast<const void*>(v));
+            append_stringification(
+                out,
+                stringification::stringify_pointer_value(reinterpret_cast<const void*>(v))
+            );
         } else if constexpr(is_smart_pointer<T>) {
             #ifndef LIBASSERT_NO_STRINGIFY_SMART_POINTER_OBJECTS
              if(stringifiable<typename T::element_type>) {
             #else
              if(false) {
             #endif
-                return stringification::stringify_smart_ptr(v);
+                return stringification::stringify_smart_ptr_into(out, v);
             } else {
-                return stringification::stringify_pointer_value(v.get());
+                append_stringification(out, stringification::stringify_pointer_value(v.get()));
             }
         } else if constexpr(std::is_enum_v<T>) {
-            return stringification::stringify_enum(v);
+            append_stringification(out, stringification::stringify_enum(v));
         } else if constexpr(stringification::is_tuple_like<T>::value) {
             if constexpr(stringifiable_container<T>()) {
-                return stringification::stringify_tuple_like(v);
+                stringification::stringify_tuple_like_into(out, v);
+                return false;
             } else {
-                return stringification::stringify_unknown<T>();
+                append_stringification(out, stringification::stringify_unknown<T>());
             }
         } else if constexpr(
             stringification::adl::is_container<T>::value
             && !std::is_same_v<strip<T>, std::filesystem::path>
         ) {
             if constexpr(stringifiable_container<T>()) {
-                return stringification::stringify_container(v);
+                stringification::stringify_container_into(out, v);
+                return false;
             } else {
-                return stringification::stringify_unknown<T>();
+                append_stringification(out, stringification::stringify_unknown<T>());
             }
+        } else if constexpr(is_specialization<T, std::optional>::value) {
+            return stringification::stringify_optional_into(out, v);
         } else if constexpr(can_basic_stringify<T>::value) {
-            return stringification::stringify(v);
+            append_stringification(out, stringification::stringify(v));
         } else if constexpr(stringification::has_ostream_overload<T>::value) {
-            return stringification::stringify_by_ostream(v);
+            stringification::stringify_by_ostream_into(out, v);
         }
         #ifdef LIBASSERT_USE_FMT
         else if constexpr(fmt::is_formattable<T>::value) {
-            return fmt::format("{}", v);
+            fmt::format_to_n(std::back_inserter(out), stringification_output_limit(), "{}", v);
         }
         #endif
         else {
-            return stringification::stringify_unknown<T>();
+            append_stringification(out, stringification::stringify_unknown<T>());
         }
         // TODO std fmt
+        return fit_stringification_budget(out, start);
     }
 
-    // Top-level stringify utility
     template<typename T>
     LIBASSERT_ATTR_COLD [[nodiscard]]
-    std::string generate_stringification(const T& v) {
-        if constexpr(
-            stringification::adl::is_container<T>::value
-            && !is_string_type<T>
-            && !std::is_same_v<strip<T>, std::filesystem::path>
-            && stringifiable_container<T>()
-        ) {
-            return prettify_type(std::string(type_name<T>())) + ": " + do_stringify(v);
-        } else if constexpr(stringification::is_tuple_like<T>::value && stringifiable_container<T>()) {
-            return prettify_type(std::string(type_name<T>())) + ": " + do_stringify(v);
-        } else if constexpr((std::is_pointer_v<T> && !is_string_type<T>) || is_smart_pointer<T>) {
-            return prettify_type(std::string(type_name<T>())) + ": " + do_stringify(v);
-        } else if constexpr(is_specialization<T, std::optional>::value) {
-            return prettify_type(std::string(type_name<T>())) + ": " + do_stringify(v);
+    std::string do_stringify(const T& v) {
+        std::string str;
+        do_stringify_into(str, v);
+        return str;
+    }
+
+    template<typename T, typename = void>
+    class has_size : public std::false_type {};
+    template<typename T>
+    class has_size<
+        T,
+        std::void_t<decltype(std::size(std::declval<const T&>()))>
+    > : public std::true_type {};
+
+    // Rough guess at how much output a value produces, used to size the buffer before rendering into it
+    template<typename T>
+    constexpr std::size_t stringification_size_estimate() {
+        if constexpr(std::is_arithmetic_v<T>) {
+            return 8;
+        } else if constexpr(is_string_type<T>) {
+            return 24;
         } else {
-            return do_stringify(v);
+            return 32;
         }
     }
+
+    template<typename T>
+    std::size_t stringification_size_estimate(const T& v) {
+        if constexpr(has_size<T>::value && has_value_type<T>::value && !is_string_type<T>) {
+            const std::size_t items = std::min(std::size_t(std::size(v)), stringification::max_container_print_items);
+            return 2 + items * (stringification_size_estimate<typename T::value_type>() + 2);
+        } else {
+            return 0; // leaves are appended as a whole anyway
+        }
+    }
+
+    // The type independent part of generate_stringification: the value's output budget, the type prefix and sizing
+    // the buffer. Out of line so each instantiation is little more than a call.
+    [[nodiscard]] LIBASSERT_EXPORT std::string generate_stringification_erased(
+        const void* value,
+        bool(*stringify_into)(std::string&, const void*),
+        std::string_view type_prefix, // empty if the type isn't shown
+        std::size_t size_estimate
+    );
+    // Same, for an assertion_info. Built in a buffer the thread keeps around so only the result is allocated.
+    [[nodiscard]] LIBASSERT_EXPORT arena_string generate_stringification_erased(
+        const void* value,
+        bool(*stringify_into)(std::string&, const void*),
+        std::string_view type_prefix,
+        std::size_t size_estimate,
+        const arena_allocator<char>& allocator
+    );
+
+    template<typename T>
+    bool stringify_erased_into(std::string& out, const void* value) {
+        return do_stringify_into(out, *static_cast<const T*>(value));
+    }
+
+    template<typename T>
+    constexpr std::string_view stringification_type_prefix() {
+        constexpr bool show_type =
+            (
+                stringification::adl::is_container<T>::value
+                && !is_string_type<T>
+                && !std::is_same_v<strip<T>, std::filesystem::path>
+                && stringifiable_container<T>()
+            )
+            || (stringification::is_tuple_like<T>::value && stringifiable_container<T>())
+            || (std::is_pointer_v<T> && !is_string_type<T>)
+            || is_smart_pointer<T>
+            || is_specialization<T, std::optional>::value;
+        if constexpr(show_type) {
+            return type_name<T>();
+        } else {
+            return {};
+        }
+    }
+
+    // Top-level stringify utility
+    template<typename T>
+    LIBASSERT_ATTR_COLD [[nodiscard]]
+    std::string generate_stringification(const T& v) {
+        return generate_stringification_erased(
+            &v,
+            stringify_erased_into<T>,
+            stringification_type_prefix<T>(),
+            stringification_size_estimate(v)
+        );
+    }
+
+    template<typename T>
+    LIBASSERT_ATTR_COLD [[nodiscard]]
+    arena_string generate_stringification(const T& v, const arena_allocator<char>& allocator) {
+        return generate_stringification_erased(
+            &v,
+            stringify_erased_into<T>,
+            stringification_type_prefix<T>(),
+            stringification_size_estimate(v),
+            allocator
+        );
+    }
+
+    // Stringification of common standard library types is instantiated once in the library. Translation units that
+    // define LIBASSERT_PRECOMPILED_STRINGIFICATION reference those instead of each instantiating identical cold code.
+    // It's opt-in because a libassert::stringifier specialization for one of these types would be ignored.
+    #if defined(LIBASSERT_PRECOMPILED_STRINGIFICATION) || defined(LIBASSERT_INSTANTIATE_PRECOMPILED_STRINGIFICATION)
+     #define LIBASSERT_PRECOMPILED_STRINGIFICATIONS(X) \
+        X(char) X(int) X(unsigned) X(long) X(unsigned long) X(long long) X(unsigned long long) \
+        X(float) X(double) X(bool) X(const char*) X(std::string) X(std::string_view) \
+        X(std::vector<char>) X(std::vector<int>) X(std::vector<unsigned>) X(std::vector<long>) \
+        X(std::vector<unsigned long>) X(std::vector<long long>) X(std::vector<unsigned long long>) \
+        X(std::vector<float>) X(std::vector<double>) X(std::vector<std::string>) \
+        X(std::optional<int>) X(std::optional<long long>) X(std::optional<double>) X(std::optional<std::string>) \
+        X(std::pair<int, int>) X(std::pair<std::string, int>) X(std::pair<std::string, std::string>) \
+        X(std::tuple<int, int>) X(std::tuple<int, int, int>) \
+        X(std::map<int, int>) X(std::map<std::string, int>) X(std::map<std::string, std::string>) \
+        X(std::unordered_map<int, int>) X(std::unordered_map<std::string, int>) \
+        X(std::unordered_map<std::string, std::string>)
+    #endif
+
+    #ifdef LIBASSERT_PRECOMPILED_STRINGIFICATION
+     #define LIBASSERT_EXTERN_STRINGIFICATION(...) \
+        extern template LIBASSERT_EXPORT bool do_stringify_into<__VA_ARGS__>(std::string&, __VA_ARGS__ const&); \
+        extern template LIBASSERT_EXPORT std::string do_stringify<__VA_ARGS__>(__VA_ARGS__ const&); \
+        extern template LIBASSERT_EXPORT std::string generate_stringification<__VA_ARGS__>(__VA_ARGS__ const&); \
+        extern template LIBASSERT_EXPORT arena_string generate_stringification<__VA_ARGS__>( \
+            __VA_ARGS__ const&, \
+            const arena_allocator<char>& \
+        );
+     LIBASSERT_PRECOMPILED_STRINGIFICATIONS(LIBASSERT_EXTERN_STRINGIFICATION)
+     #undef LIBASSERT_EXTERN_STRINGIFICATION
+    #endif
+
+    // the library keeps the list to instantiate it
+    #ifndef LIBASSERT_INSTANTIATE_PRECOMPILED_STRINGIFICATION
+     #undef LIBASSERT_PRECOMPILED_STRINGIFICATIONS
+    #endif
 }
 
 #endif
@@ -1,9 +1,15 @@
 #ifndef LIBASSERT_UTILITIES_HPP
 #define LIBASSERT_UTILITIES_HPP
 
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
 #include <type_traits>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <libassert/platform.hpp>
 
@@ -140,4 +146,185 @@ namespace libassert::detail {
     template<typename T> typename std::add_lvalue_reference_t<T> decllval() noexcept;
 }
 
+// =====================================================================================================================
+// || Basic stringification                                                                                           ||
+// =====================================================================================================================
+
+namespace libassert {
+    // customization point
+    template<typename T> struct stringifier /*{
+        std::convertible_to<std::string> stringify(const T&);
+    }*/;
+}
+
+namespace libassert::detail::stringification {
+    // The parts of the stringification micro-library that don't need anything heavier than <string>, the rest is in
+    // stringification.hpp
+
+    template<typename T, typename = void> class has_stringifier : public std::false_type {};
+    template<typename T>
+    class has_stringifier<
+        T,
+        std::void_t<decltype(stringifier<strip<T>>{}.stringify(std::declval<T>()))>
+    > : public std::true_type {};
+
+    //
+    // Catch all
+    //
+
+    template<typename T>
+    [[nodiscard]] std::string stringify_unknown() {
+        return bstringf("<instance of %s>", prettify_type(std::string(type_name<T>())).c_str());
+    }
+
+    //
+    // Basic types
+    //
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::string_view);
+    // Same as stringify(std::string_view), escaping straight into out
+    LIBASSERT_EXPORT void stringify_into(std::string& out, std::string_view);
+    // without nullptr_t overload msvc (without /permissive-) will call stringify(bool) and mingw
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(std::nullptr_t);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(char);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(bool);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(short);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(int);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long long);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned short);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned int);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned long);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(unsigned long long);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(float);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(double);
+    [[nodiscard]] LIBASSERT_EXPORT std::string stringify(long double);
+    [[nodiscard]] LIBASSERT_EXPORT
+    std::string stringify_pointer_value(const void*);
+}
+
+namespace libassert::detail {
+    //
+    // Output budget, see libassert::set_stringification_budget
+    //
+
+    // Bytes of output stringification can still produce on this thread before it starts eliding
+    [[nodiscard]] LIBASSERT_EXPORT std::size_t stringification_budget_remaining();
+    // Charges a stringified leaf value to the budget, or replaces it with the elision marker if it doesn't fit
+    [[nodiscard]] LIBASSERT_EXPORT std::string fit_stringification_budget(std::string str);
+    // Same, for a leaf value that has been appended to out starting at start. Returns true if it was elided.
+    LIBASSERT_EXPORT bool fit_stringification_budget(std::string& out, std::size_t start);
+    LIBASSERT_EXPORT void charge_stringification_budget(std::size_t bytes);
+
+    // How much output to take from a stringification that can't check the budget as it goes: one byte more than what's
+    // left, so that fit_stringification_budget still sees that it didn't fit
+    inline std::size_t stringification_output_limit() {
+        const std::size_t remaining = stringification_budget_remaining();
+        return remaining == std::numeric_limits<std::size_t>::max() ? remaining : remaining + 1;
+    }
+
+    inline constexpr std::string_view elision_marker = "...";
+
+    // Limits output to the per-value or per-assertion budget for its lifetime. Scopes nest, an inner scope can only
+    // narrow the budget and output produced in it is charged to the enclosing scopes as well.
+    class LIBASSERT_EXPORT stringification_budget_scope {
+        std::size_t previous_limit;
+    public:
+        enum kind { value, assertion };
+        explicit stringification_budget_scope(kind);
+        ~stringification_budget_scope();
+        stringification_budget_scope(const stringification_budget_scope&) = delete;
+        stringification_budget_scope(stringification_budget_scope&&) = delete;
+        stringification_budget_scope& operator=(const stringification_budget_scope&) = delete;
+        stringification_budget_scope& operator=(stringification_budget_scope&&) = delete;
+    };
+}
+
+namespace libassert::detail {
+    //
+    // Failure arenas, see libassert::set_failure_arena_size
+    //
+
+    class monotonic_arena;
+
+    [[nodiscard]] LIBASSERT_EXPORT void* arena_allocate(monotonic_arena* arena, std::size_t size, std::size_t alignment);
+
+    // Allocates from the arena it's constructed with, or from the global allocator if it's given none. Arena memory is
+    // only reclaimed when the arena is reset at the start of its thread's next failure. Copies of containers always use
+    // the global allocator since they can outlive the failure.
+    template<typename T>
+    class arena_allocator {
+        monotonic_arena* arena = nullptr;
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        arena_allocator() noexcept = default;
+        explicit arena_allocator(monotonic_arena* arena_) noexcept : arena(arena_) {}
+        template<typename U>
+        arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.get_arena()) {} // NOLINT(*-explicit-constructor)
+
+        T* allocate(std::size_t n) {
+            if(!arena) {
+                return std::allocator<T>{}.allocate(n);
+            }
+            if(n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(arena_allocate(arena, n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept {
+            if(!arena) {
+                std::allocator<T>{}.deallocate(ptr, n);
+            }
+        }
+
+        arena_allocator select_on_container_copy_construction() const noexcept {
+            return arena_allocator();
+        }
+
+        monotonic_arena* get_arena() const noexcept {
+            return arena;
+        }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const arena_allocator<T>& a, const arena_allocator<U>& b) noexcept {
+        return a.get_arena() == b.get_arena();
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const arena_allocator<T>& a, const arena_allocator<U>& b) noexcept {
+        return !(a == b);
+    }
+
+    // Marks the current thread as handling a failure for its lifetime. The thread's arena is reset when the outermost
+    // scope begins, not when it ends, as the assertion_info being handled can still own arena memory while it's
+    // destroyed or unwound. Nested scopes share the outer scope's arena.
+    class LIBASSERT_EXPORT failure_arena_scope {
+        monotonic_arena* arena_;
+    public:
+        failure_arena_scope();
+        ~failure_arena_scope();
+        failure_arena_scope(const failure_arena_scope&) = delete;
+        failure_arena_scope(failure_arena_scope&&) = delete;
+        failure_arena_scope& operator=(const failure_arena_scope&) = delete;
+        failure_arena_scope& operator=(failure_arena_scope&&) = delete;
+        // nullptr if arenas are disabled
+        monotonic_arena* arena() const noexcept {
+            return arena_;
+        }
+    };
+}
+
+namespace libassert {
+    // Strings and vectors in assertion_info, in the failure arena of the thread that built it if there was one
+    using arena_string = std::basic_string<char, std::char_traits<char>, detail::arena_allocator<char>>;
+    template<typename T>
+    using arena_vector = std::vector<T, detail::arena_allocator<T>>;
+}
+
 #endif
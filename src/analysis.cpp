@@ -1,11 +1,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <cctype>
-#include <initializer_list>
 #include <iterator>
-#include <memory>
-#include <mutex>
-#include <regex>
 #include <set>
 #include <stdexcept>
 #include <string_view>
@@ -29,15 +25,48 @@ namespace libassert::detail {
      */
 
     LIBASSERT_ATTR_COLD
-    std::string union_regexes(std::initializer_list<std::string_view> regexes) {
-        std::string composite;
-        for(const std::string_view str : regexes) {
-            if(!composite.empty()) {
-                composite += "|";
+    static bool is_regex_space(char c) {
+        return needle(c).is_in(' ', '\t', '\n', '\v', '\f', '\r');
+    }
+
+    LIBASSERT_ATTR_COLD
+    static bool is_word_char(char c) {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    // Matches std::name or std::x::name at i, e.g. std::__cxx11::basic_string<char, returns the match length or 0
+    LIBASSERT_ATTR_COLD
+    static std::size_t match_std_name(std::string_view str, std::size_t i, std::string_view name) {
+        if(str.substr(i, 5) != "std::") {
+            return 0;
+        }
+        std::size_t j = i + 3;
+        if(str.substr(j + 2, name.size()) != name) {
+            // try an inline namespace
+            std::size_t k = j + 2;
+            while(k < str.size() && is_word_char(str[k])) {
+                k++;
+            }
+            if(k == j + 2 || str.substr(k, 2) != "::" || str.substr(k + 2, name.size()) != name) {
+                return 0;
             }
-            composite += "(?:" + std::string(str) + ")";
+            j = k;
         }
-        return composite;
+        return j + 2 + name.size() - i;
+    }
+
+    // Matches ,\s*std::name or ,\s*std::x::name at i, returns the match length or 0
+    LIBASSERT_ATTR_COLD
+    static std::size_t match_std_template_argument(std::string_view str, std::size_t i, std::string_view name) {
+        if(i >= str.size() || str[i] != ',') {
+            return 0;
+        }
+        std::size_t j = i + 1;
+        while(j < str.size() && is_regex_space(str[j])) {
+            j++;
+        }
+        const std::size_t length = match_std_name(str, j, name);
+        return length ? j + length - i : 0;
     }
 
     LIBASSERT_ATTR_COLD
@@ -46,34 +75,63 @@ namespace libassert::detail {
         // could put in analysis:: but the replacement is basic and this is more convenient for
         // using in the stringifier too
         replace_all_dynamic(type, "> >", ">>");
-        // "," -> ", " and " ," -> ", "
-        static const std::regex comma_re(R"(\s*,\s*)");
-        replace_all(type, comma_re, ", ");
+        // "," -> ", " and " ," -> ", " as well as
         // class C -> C for msvc
-        static const std::regex class_re(R"(\b(class|struct)\s+)");
-        replace_all(type, class_re, "");
+        std::string normalized;
+        normalized.reserve(type.size());
+        std::size_t last_comma = 0; // don't eat the space from a previous ", "
+        for(std::size_t i = 0; i < type.size(); ) {
+            if(type[i] == ',') {
+                while(normalized.size() > last_comma && is_regex_space(normalized.back())) {
+                    normalized.pop_back();
+                }
+                normalized += ", ";
+                last_comma = normalized.size();
+                i++;
+                while(i < type.size() && is_regex_space(type[i])) {
+                    i++;
+                }
+                continue;
+            }
+            if(normalized.empty() || !is_word_char(normalized.back())) {
+                const auto keyword = std::string_view(type).substr(i, 6);
+                const std::size_t keyword_length = keyword.substr(0, 5) == "class" ? 5 : keyword == "struct" ? 6 : 0;
+                if(keyword_length && i + keyword_length < type.size() && is_regex_space(type[i + keyword_length])) {
+                    i += keyword_length;
+                    while(i < type.size() && is_regex_space(type[i])) {
+                        i++;
+                    }
+                    continue;
+                }
+            }
+            normalized += type[i++];
+        }
+        type = std::move(normalized);
         // `anonymous namespace' -> (anonymous namespace) for msvc
         // this brings it in-line with other compilers and prevents any tokenization/highlighting issues
-        static const std::regex msvc_anonymous_namespace("`anonymous namespace'");
-        replace_all(type, msvc_anonymous_namespace, "(anonymous namespace)");
+        replace_all(type, "`anonymous namespace'", "(anonymous namespace)");
         // rules to replace std::basic_string -> std::string and std::basic_string_view -> std::string_view
         // rule to replace ", std::allocator<whatever>"
-        static const std::pair<std::regex, std::string_view> basic_string = {
-            std::regex(R"(std(::[a-zA-Z0-9_]+)?::basic_string<char)"), "std::string"
-        };
-        replace_all_template(type, basic_string);
-        static const std::pair<std::regex, std::string_view> basic_string_view = {
-            std::regex(R"(std(::[a-zA-Z0-9_]+)?::basic_string_view<char)"), "std::string_view"
-        };
-        replace_all_template(type, basic_string_view);
-        static const std::pair<std::regex, std::string_view> allocator = {
-            std::regex(R"(,\s*std(::[a-zA-Z0-9_]+)?::allocator<)"), ""
-        };
-        replace_all_template(type, allocator);
-        static const std::pair<std::regex, std::string_view> default_delete = {
-            std::regex(R"(,\s*std(::[a-zA-Z0-9_]+)?::default_delete<)"), ""
-        };
-        replace_all_template(type, default_delete);
+        replace_all_template(
+            type,
+            [](std::string_view str, std::size_t i) { return match_std_name(str, i, "basic_string<char"); },
+            "std::string"
+        );
+        replace_all_template(
+            type,
+            [](std::string_view str, std::size_t i) { return match_std_name(str, i, "basic_string_view<char"); },
+            "std::string_view"
+        );
+        replace_all_template(
+            type,
+            [](std::string_view str, std::size_t i) { return match_std_template_argument(str, i, "allocator<"); },
+            ""
+        );
+        replace_all_template(
+            type,
+            [](std::string_view str, std::size_t i) { return match_std_template_argument(str, i, "default_delete<"); },
+            ""
+        );
         // replace std::__cxx11 -> std:: for gcc dual abi
         // https://gcc.gnu.org/onlinedocs/libstdc++/manual/using_dual_abi.html
         replace_all_dynamic(type, "std::__cxx11::", "std::");
@@ -82,19 +140,14 @@ namespace libassert::detail {
 
     class analysis {
     public:
-        // Analysis singleton, lazy-initialize all the regex nonsense
-        // 8 BSS bytes and <512 bytes heap bytes not a problem
-        static std::unique_ptr<analysis> analysis_singleton;
-        static std::mutex singleton_mutex;
-        static analysis& get() {
-            const std::unique_lock lock(singleton_mutex);
-            if(analysis_singleton == nullptr) {
-                analysis_singleton = std::unique_ptr<analysis>(new analysis);
-            }
-            return *analysis_singleton;
+        // Analysis singleton, lazy-initialize the lookup tables
+        // The tables are immutable once built. Initialization of the function-local static is thread-safe and after it
+        // completes lookups are just a guard check, no lock is taken.
+        static const analysis& get() {
+            static const analysis instance;
+            return instance;
         }
 
-        std::regex escapes_re;
         std::unordered_map<std::string_view, int> precedence;
         std::unordered_map<std::string_view, std::string_view> braces = {
             // template angle brackets excluded from this analysis
@@ -125,101 +178,10 @@ namespace libassert::detail {
         std::unordered_set<std::string_view> bitwise_operators = {
             "^", "&", "|", "^=", "&=", "|=", "xor", "bitand", "bitor", "and_eq", "or_eq", "xor_eq"
         };
-        std::vector<std::pair<std::regex, literal_format>> literal_formats;
 
     private:
         LIBASSERT_ATTR_COLD
         analysis() {
-            // https://eel.is/c++draft/gram.lex
-            // generate regular expressions
-            std::string keywords[] = { "alignas", "constinit", "public", "alignof", "const_cast",
-                "float", "register", "try", "asm", "continue", "for", "reinterpret_cast", "typedef",
-                "auto", "co_await", "friend", "requires", "typeid", "bool", "co_return", "goto",
-                "return", "typename", "break", "co_yield", "if", "short", "union", "case",
-                "decltype", "inline", "signed", "unsigned", "catch", "default", "int", "sizeof",
-                "using", "char", "delete", "long", "static", "virtual", "char8_t", "do", "mutable",
-                "static_assert", "void", "char16_t", "double", "namespace", "static_cast",
-                "volatile", "char32_t", "dynamic_cast", "new", "struct", "wchar_t", "class", "else",
-                "noexcept", "switch", "while", "concept", "enum", "template", "const", "explicit",
-                "operator", "this", "consteval", "export", "private", "thread_local", "constexpr",
-                "extern", "protected", "throw" };
-            std::string punctuators[] = { "{", "}", "[", "]", "(", ")", "<:", ":>", "<%",
-                "%>", ";", ":", "...", "?", "::", ".", ".*", "->", "->*", "~", "!", "+", "-", "*",
-                "/", "%", "^", "&", "|", "=", "+=", "-=", "*=", "/=", "%=", "^=", "&=", "|=", "==",
-                "!=", "<", ">", "<=", ">=", "<=>", "&&", "||", "<<", ">>", "<<=", ">>=", "++", "--",
-                ",", "and", "or", "xor", "not", "bitand", "bitor", "compl", "and_eq", "or_eq",
-                "xor_eq", "not_eq", "#" }; // # appears in some lambda signatures
-            // Sort longest -> shortest (secondarily A->Z)
-            const auto cmp = [](const std::string_view a, const std::string_view b) {
-                if(a.length() > b.length()) { return true; }
-                else if(a.length() == b.length()) { return a < b; }
-                else { return false; }
-            };
-            std::sort(std::begin(keywords), std::end(keywords), cmp);
-            std::sort(std::begin(punctuators), std::end(punctuators), cmp);
-            // Escape special characters and add wordbreaks
-            const std::regex special_chars { R"([-[\]{}()*+?.,\^$|#\s])" };
-            std::transform(std::begin(punctuators), std::end(punctuators), std::begin(punctuators),
-                [&special_chars](const std::string& str) {
-                    return std::regex_replace(str + (isalpha(str[0]) ? "\\b" : ""), special_chars, "\\$&");
-                });
-            // https://eel.is/c++draft/lex.pptoken#3.2
-            *std::find(std::begin(punctuators), std::end(punctuators), "<:") += "(?!:[^:>])";
-            // regular expressions
-            // numeric literals
-            const std::string optional_integer_suffix = "(?:[Uu](?:LL?|ll?|Z|z)?|(?:LL?|ll?|Z|z)[Uu]?)?";
-            const std::string int_binary  = "0[Bb][01](?:'?[01])*" + optional_integer_suffix;
-            // slightly modified from grammar so 0 is lexed as a decimal literal instead of octal
-            const std::string int_octal   = "0(?:'?[0-7])+" + optional_integer_suffix;
-            const std::string int_decimal = "(?:0|[1-9](?:'?\\d)*)" + optional_integer_suffix;
-            const std::string int_hex        = "0[Xx](?!')(?:'?[\\da-fA-F])+" + optional_integer_suffix;
-            const std::string digit_sequence = "\\d(?:'?\\d)*";
-            const std::string fractional_constant = microfmt::format(
-                "(?:(?:{})?\\.{}|{}\\.)",
-                digit_sequence,
-                digit_sequence,
-                digit_sequence
-            );
-            const std::string exponent_part = "(?:[Ee][\\+-]?" + digit_sequence + ")";
-            const std::string suffix = "[FfLl]";
-            const std::string float_decimal = microfmt::format(
-                "(?:{}{}?|{}{}){}?",
-                fractional_constant,
-                exponent_part,
-                digit_sequence,
-                exponent_part,
-                suffix
-            );
-            const std::string hex_digit_sequence = "[\\da-fA-F](?:'?[\\da-fA-F])*";
-            const std::string hex_frac_const = microfmt::format(
-                "(?:(?:{})?\\.{}|{}\\.)",
-                hex_digit_sequence,
-                hex_digit_sequence,
-                hex_digit_sequence
-            );
-            const std::string binary_exp = "[Pp][\\+-]?" + digit_sequence;
-            const std::string float_hex = microfmt::format(
-                "0[Xx](?:{}|{}){}{}?",
-                hex_frac_const,
-                hex_digit_sequence,
-                binary_exp,
-                suffix
-            );
-            // char and string literals
-            // TODO: This needs to be updated
-            const std::string escapes = R"(\\[0-7]{1,3}|\\x[\da-fA-F]+|\\.)";
-            const std::string char_literal = R"((?:u8|[UuL])?'(?:)" + escapes + R"(|[^\n'])*')";
-            escapes_re = std::regex(escapes);
-            // setup literal format rules
-            literal_formats = {
-                { std::regex(int_binary),    literal_format::integer_binary },
-                { std::regex(int_octal),     literal_format::integer_octal },
-                { std::regex(int_decimal),   literal_format::default_format },
-                { std::regex(int_hex),       literal_format::integer_hex },
-                { std::regex(float_decimal), literal_format::default_format },
-                { std::regex(float_hex),     literal_format::float_hex },
-                { std::regex(char_literal),  literal_format::default_format }
-            };
             // generate precedence table
             // bottom few rows of the precedence table:
             const std::unordered_map<int, std::vector<std::string_view>> precedences = {
@@ -247,7 +209,7 @@ namespace libassert::detail {
 
     public:
         LIBASSERT_ATTR_COLD
-        std::string_view normalize_op(const std::string_view op) {
+        std::string_view normalize_op(const std::string_view op) const {
             // Operators need to be normalized to support alternative operators like and and bitand
             // Normalization instead of just adding to the precedence table because target operators
             // will always be the normalized operator even when the alternative operator is used.
@@ -259,7 +221,7 @@ namespace libassert::detail {
         }
 
         LIBASSERT_ATTR_COLD
-        std::string_view normalize_brace(const std::string_view brace) {
+        std::string_view normalize_brace(const std::string_view brace) const {
             // Operators need to be normalized to support alternative operators like and and bitand
             // Normalization instead of just adding to the precedence table because target operators
             // will always be the normalized operator even when the alternative operator is used.
@@ -273,18 +235,19 @@ namespace libassert::detail {
         LIBASSERT_ATTR_COLD
         std::vector<highlight_block> highlight_string(std::string_view str, const color_scheme& scheme) const {
             std::vector<highlight_block> output;
-            std::cmatch match;
-            std::size_t i = 0;
-            // NOLINTNEXTLINE(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions)
-            while(std::regex_search(str.data() + i, str.data() + str.size(), match, escapes_re)) {
-                // add string part
-                // TODO: I don't know why this assert was added, I might have done it in dev on a whim. Re-evaluate.
-                // LIBASSERT_PRIMITIVE_DEBUG_ASSERT(match.position() > 0);
-                if(match.position() > 0) {
-                    output.push_back({scheme.string, str.substr(i, match.position())});
+            std::size_t i = 0; // start of the current string part
+            for(std::size_t j = 0; j < str.size(); ) {
+                if(const auto length = escape_sequence_length(str, j)) {
+                    // add string part
+                    if(j > i) {
+                        output.push_back({scheme.string, str.substr(i, j - i)});
+                    }
+                    output.push_back({scheme.escape, str.substr(j, length)});
+                    j += length;
+                    i = j;
+                } else {
+                    j++;
                 }
-                output.push_back({scheme.escape, str.substr(i + match.position(), match.length())});
-                i += match.position() + match.length();
             }
             if(i < str.length()) {
                 output.push_back({scheme.string, str.substr(i)});
@@ -295,7 +258,7 @@ namespace libassert::detail {
         LIBASSERT_ATTR_COLD
         // TODO: Refactor
         // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-        std::vector<highlight_block> highlight(std::string_view expression, const color_scheme& scheme) try {
+        std::vector<highlight_block> highlight(std::string_view expression, const color_scheme& scheme) const try {
             const auto res = tokenize(expression);
             if(!res) {
                 return {{"", expression}};
@@ -362,13 +325,8 @@ namespace libassert::detail {
         }
 
         LIBASSERT_ATTR_COLD
-        literal_format get_literal_format(std::string_view expression) {
-            for(auto& [ re, type ] : literal_formats) {
-                if(std::regex_match(expression.begin(), expression.end(), re)) {
-                    return type;
-                }
-            }
-            return literal_format::default_format; // not a literal // TODO
+        literal_format get_literal_format(std::string_view expression) const {
+            return classify_literal(expression).value_or(literal_format::default_format); // not a literal // TODO
         }
 
         LIBASSERT_ATTR_COLD
@@ -406,7 +364,7 @@ namespace libassert::detail {
             int middle_index, // where the split currently is, current op = tokens[middle_index]
             int depth,
             std::set<int>& output
-        ) {
+        ) const {
             #ifdef _0_DEBUG_ASSERT_DISAMBIGUATION
             (void)fprintf(stderr, "*");
             #endif
@@ -563,7 +521,7 @@ namespace libassert::detail {
         std::pair<std::string, std::string> decompose_expression(
             std::string_view expression,
             std::string_view target_op
-        ) {
+        ) const {
             // While automatic decomposition allows something like `assert(foo(n) == bar<n> + n);`
             // treated as `assert_eq(foo(n), bar<n> + n);` we only get the full expression's string
             // representation.
@@ -648,9 +606,6 @@ namespace libassert::detail {
         }
     };
 
-    std::unique_ptr<analysis> analysis::analysis_singleton;
-    std::mutex analysis::singleton_mutex;
-
     LIBASSERT_ATTR_COLD
     std::string highlight(std::string_view expression, const color_scheme& scheme) {
         if(scheme == libassert::color_scheme::blank) {
@@ -0,0 +1,107 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "common.hpp"
+
+namespace libassert::detail {
+    namespace {
+        std::atomic<std::size_t> failure_arena_size = 0; // 0 = disabled
+
+        struct thread_arena_state {
+            std::unique_ptr<monotonic_arena> arena;
+            monotonic_arena* current = nullptr;
+            int depth = 0;
+        };
+
+        thread_arena_state& get_thread_arena_state() {
+            thread_local thread_arena_state state;
+            return state;
+        }
+
+        std::size_t align_up(std::size_t value, std::size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    LIBASSERT_ATTR_COLD monotonic_arena::monotonic_arena(std::size_t capacity)
+        : buffer(new std::byte[capacity]), buffer_capacity(capacity) {}
+
+    LIBASSERT_ATTR_COLD monotonic_arena::~monotonic_arena() {
+        reset();
+    }
+
+    LIBASSERT_ATTR_COLD void* monotonic_arena::allocate(std::size_t size, std::size_t alignment) {
+        alignment = std::max(alignment, alignof(std::max_align_t));
+        const auto base = reinterpret_cast<std::uintptr_t>(buffer.get());
+        const std::size_t start = align_up(base + used, alignment) - base;
+        if(start <= buffer_capacity && size <= buffer_capacity - start) {
+            used = start + size;
+            return buffer.get() + start;
+        }
+        // out of space, the block is tracked so it can be freed on reset
+        const std::size_t header = align_up(sizeof(overflow_block), alignment);
+        auto* block = static_cast<overflow_block*>(::operator new(header + size, std::align_val_t(alignment)));
+        block->next = overflow;
+        block->alignment = alignment;
+        overflow = block;
+        return reinterpret_cast<std::byte*>(block) + header;
+    }
+
+    LIBASSERT_ATTR_COLD void monotonic_arena::reset() {
+        used = 0;
+        while(overflow) {
+            auto* next = overflow->next;
+            ::operator delete(overflow, std::align_val_t(overflow->alignment));
+            overflow = next;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void* arena_allocate(monotonic_arena* arena, std::size_t size, std::size_t alignment) {
+        return arena->allocate(size, alignment);
+    }
+
+    monotonic_arena* current_failure_arena() noexcept {
+        return get_thread_arena_state().current;
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT failure_arena_scope::failure_arena_scope() : arena_(nullptr) {
+        auto& state = get_thread_arena_state();
+        if(state.depth++ > 0) {
+            arena_ = state.current;
+            return;
+        }
+        const std::size_t size = failure_arena_size.load(std::memory_order_relaxed);
+        if(size == 0) {
+            state.arena.reset();
+            return;
+        }
+        if(state.arena && state.arena->capacity() == size) {
+            state.arena->reset();
+        } else {
+            state.arena = std::make_unique<monotonic_arena>(size);
+        }
+        state.current = state.arena.get();
+        arena_ = state.current;
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT failure_arena_scope::~failure_arena_scope() {
+        auto& state = get_thread_arena_state();
+        if(--state.depth == 0) {
+            state.current = nullptr;
+        }
+    }
+}
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void set_failure_arena_size(std::size_t bytes) {
+        detail::failure_arena_size = bytes;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <libassert/assert.hpp>
+
+#include "common.hpp"
+
+namespace libassert::detail {
+    // Bump allocator, memory is only reclaimed all at once by reset(). Once the buffer is used up further allocations
+    // come from the global allocator and are freed on reset.
+    class monotonic_arena {
+        struct overflow_block {
+            overflow_block* next;
+            std::size_t alignment;
+        };
+        std::unique_ptr<std::byte[]> buffer;
+        std::size_t buffer_capacity;
+        std::size_t used = 0;
+        overflow_block* overflow = nullptr;
+    public:
+        explicit monotonic_arena(std::size_t capacity);
+        ~monotonic_arena();
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+        void* allocate(std::size_t size, std::size_t alignment);
+        void reset();
+        std::size_t capacity() const {
+            return buffer_capacity;
+        }
+    };
+
+    // The current thread's arena while it's handling a failure and arenas are enabled, nullptr otherwise
+    LIBASSERT_EXPORT_TESTING monotonic_arena* current_failure_arena() noexcept;
+
+    struct arena_string_hash {
+        std::size_t operator()(const arena_string& str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    template<typename K, typename V, typename Hash = std::hash<K>>
+    using arena_unordered_map = std::unordered_map<K, V, Hash, std::equal_to<K>, arena_allocator<std::pair<const K, V>>>;
+
+    template<typename V>
+    using arena_string_map = arena_unordered_map<arena_string, V, arena_string_hash>;
+}
+
+#endif
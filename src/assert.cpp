@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -13,7 +14,8 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <regex>
+#include <new>
+#include <optional>
 #include <string_view>
 #include <string>
 #include <system_error>
@@ -30,13 +32,18 @@
  #include <cpptrace/cpptrace.hpp>
 #endif
 
+#include "arena.hpp"
 #include "common.hpp"
+#include "deferred_reporting.hpp"
+#include "emergency.hpp"
 #include "utils.hpp"
 #include "microfmt.hpp"
 #include "analysis.hpp"
 #include "platform.hpp"
 #include "paths.hpp"
 #include "printing.hpp"
+#include "site_cache.hpp"
+#include "trace_cache.hpp"
 
 #if LIBASSERT_IS_MSVC
  // wchar -> char string warning
@@ -69,21 +76,30 @@ namespace libassert::detail {
         return std::pair(start, end);
     }
 
-    struct stacktrace_result {
-        std::string printed;
+    // appends everything written to it to a string
+    class string_sink : public report_sink {
+        std::string& output;
+    public:
+        explicit string_sink(std::string& output_) : output(output_) {}
+        void write(std::string_view str) override {
+            output += str;
+        }
     };
 
-    LIBASSERT_ATTR_COLD [[nodiscard]]
+    // Writes the trace one frame at a time so the whole trace is never built up in memory
+    LIBASSERT_ATTR_COLD
     // TODO
     // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-    std::string print_stacktrace(
+    void print_stacktrace(
         const cpptrace::stacktrace& trace,
         int term_width,
         const color_scheme& scheme,
-        path_handler* path_handler
+        path_handler* path_handler,
+        report_sink& sink
     ) {
         if(trace.empty()) {
-            return "Empty stacktrace.\n";
+            sink.write("Empty stacktrace.\n");
+            return;
         }
         // [start, end] is an inclusive range
         auto [start, end] = get_trace_window(trace);
@@ -111,7 +127,6 @@ namespace libassert::detail {
         const size_t max_line_number_width = n_digits(max_line_number.value_or(0));
         const size_t max_frame_width = n_digits(end - start);
         // do the actual trace printing
-        std::string stacktrace;
         for(size_t i = start; i <= end; i++) {
             const auto& [raw_address, obj_address, line, col, source_path, signature_, is_inline] = trace.frames[i];
             const std::string line_number = line.has_value() ? std::to_string(line.value()) : "?";
@@ -146,18 +161,18 @@ namespace libassert::detail {
                     {{"", std::string(path_handler->resolve_path(source_path)) + ":"}},
                     highlight_blocks(line_number, scheme)
                 );
-                stacktrace += wrapped_print(
+                sink.write(wrapped_print(
                     {
                         { left, {{"", "#"}, {scheme.number, std::to_string(frame_number)}}, true },
                         { file_width + 1 + line_number_width, location_blocks },
                         { sig_width, sig }
                     },
                     scheme
-                );
+                ));
             } else {
                 auto sig = detail::highlight(signature + "(", scheme); // hack for the highlighter
                 sig = sig.substr(0, sig.rfind('('));
-                stacktrace += microfmt::format(
+                sink.write(microfmt::format(
                     "#{}{>2}{} {}\n      at {}:{}{}{}\n",
                     scheme.number,
                     frame_number,
@@ -167,23 +182,120 @@ namespace libassert::detail {
                     scheme.number,
                     line_number,
                     scheme.reset // yes this is excessive; intentionally coloring "?"
-                );
+                ));
             }
             if(recursion_folded) {
                 i += recursion_folded;
                 const std::string s = microfmt::format("| {} layers of recursion were folded |", recursion_folded);
-                stacktrace += microfmt::format("{}|{<{}}|{}\n", scheme.accent, s.size() - 2, "", scheme.reset);
-                stacktrace += microfmt::format("{}{}{}\n", scheme.accent, s, scheme.reset);
-                stacktrace += microfmt::format("{}|{<{}}|{}\n", scheme.accent, s.size() - 2, "", scheme.reset);
+                sink.write(microfmt::format("{}|{<{}}|{}\n", scheme.accent, s.size() - 2, "", scheme.reset));
+                sink.write(microfmt::format("{}{}{}\n", scheme.accent, s, scheme.reset));
+                sink.write(microfmt::format("{}|{<{}}|{}\n", scheme.accent, s.size() - 2, "", scheme.reset));
+            }
+        }
+    }
+
+    /*
+     * json output
+     */
+
+    LIBASSERT_ATTR_COLD
+    static void write_json_string(report_sink& sink, std::string_view str) {
+        sink.write("\"");
+        std::size_t run = 0; // start of the current run of characters which don't need escaping
+        for(std::size_t i = 0; i < str.size(); i++) {
+            const auto c = static_cast<unsigned char>(str[i]);
+            if(c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            sink.write(str.substr(run, i - run));
+            run = i + 1;
+            switch(c) {
+                case '"':  sink.write("\\\""); break;
+                case '\\': sink.write("\\\\"); break;
+                case '\n': sink.write("\\n"); break;
+                case '\r': sink.write("\\r"); break;
+                case '\t': sink.write("\\t"); break;
+                default:
+                    {
+                        constexpr std::string_view hex = "0123456789abcdef";
+                        const char escape[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+                        sink.write({escape, sizeof(escape)});
+                    }
             }
         }
+        sink.write(str.substr(run));
+        sink.write("\"");
+    }
+
+    LIBASSERT_ATTR_COLD
+    static void write_json_number(report_sink& sink, std::uint64_t value, int base = 10) {
+        char buffer[24];
+        const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value, base).ptr;
+        sink.write({buffer, static_cast<std::size_t>(end - buffer)});
+    }
+
+    LIBASSERT_ATTR_COLD
+    static void write_json_expression_value(report_sink& sink, std::string_view expression, std::string_view value) {
+        sink.write("{\"expression\":");
+        write_json_string(sink, expression);
+        sink.write(",\"value\":");
+        write_json_string(sink, value);
+        sink.write("}");
+    }
+
+    LIBASSERT_ATTR_COLD
+    static void write_json_frame(report_sink& sink, const cpptrace::stacktrace_frame& frame) {
+        sink.write("{\"address\":\"0x");
+        write_json_number(sink, frame.raw_address, 16);
+        sink.write("\",\"file\":");
+        write_json_string(sink, frame.filename);
+        sink.write(",\"line\":");
+        if(frame.line.has_value()) {
+            write_json_number(sink, frame.line.value());
+        } else {
+            sink.write("null");
+        }
+        sink.write(",\"column\":");
+        if(frame.column.has_value()) {
+            write_json_number(sink, frame.column.value());
+        } else {
+            sink.write("null");
+        }
+        sink.write(",\"symbol\":");
+        write_json_string(sink, frame.symbol);
+        sink.write(frame.is_inline ? ",\"inline\":true}" : ",\"inline\":false}");
+    }
+
+    LIBASSERT_ATTR_COLD
+    static std::string_view assert_type_name(assert_type type) {
+        switch(type) {
+            case assert_type::debug_assertion: return "debug_assertion";
+            case assert_type::assertion:       return "assertion";
+            case assert_type::assumption:      return "assumption";
+            case assert_type::panic:           return "panic";
+            case assert_type::unreachable:     return "unreachable";
+            default:
+                return "unknown";
+        }
+    }
+
+    LIBASSERT_ATTR_COLD [[nodiscard]]
+    std::string print_stacktrace(
+        const cpptrace::stacktrace& trace,
+        int term_width,
+        const color_scheme& scheme,
+        path_handler* path_handler
+    ) {
+        std::string stacktrace;
+        string_sink sink(stacktrace);
+        print_stacktrace(trace, term_width, scheme, path_handler, sink);
         return stacktrace;
     }
 
     LIBASSERT_ATTR_COLD
-    static std::string print_values(const std::vector<std::string>& vec, size_t lw, const color_scheme& scheme) {
+    static arena_string print_values(const arena_vector<arena_string>& vec, size_t lw, const color_scheme& scheme) {
         LIBASSERT_PRIMITIVE_DEBUG_ASSERT(!vec.empty());
-        std::string values;
+        arena_string values(vec.get_allocator());
         if(vec.size() == 1) {
             values += microfmt::format("{}\n", indent(detail::highlight(vec[0], scheme), 8 + lw + 4, ' ', true));
         } else {
@@ -202,7 +314,7 @@ namespace libassert::detail {
     }
 
     LIBASSERT_ATTR_COLD
-    static std::vector<highlight_block> get_values(const std::vector<std::string>& vec, const color_scheme& scheme) {
+    static std::vector<highlight_block> get_values(const arena_vector<arena_string>& vec, const color_scheme& scheme) {
         LIBASSERT_PRIMITIVE_DEBUG_ASSERT(!vec.empty());
         if(vec.size() == 1) {
             return highlight_blocks(vec[0], scheme);
@@ -226,29 +338,34 @@ namespace libassert::detail {
     constexpr size_t where_indent = 8;
     std::string arrow = "=>";
 
+    // The report's sections are built with the assertion_info's allocator
     LIBASSERT_ATTR_COLD [[nodiscard]]
-    std::string print_binary_diagnostics(
+    arena_string print_binary_diagnostics(
         const binary_diagnostics_descriptor& diagnostics,
         size_t term_width,
-        const color_scheme& scheme
+        const color_scheme& scheme,
+        const arena_allocator<char>& allocator
     ) {
         auto& [
             left_expression,
             right_expression,
             left_stringification,
             right_stringification,
-            multiple_formats
+            multiple_formats,
+            range_differences
         ] = diagnostics;
         // TODO: Temporary hack while reworking
-        std::vector<std::string> lstrings = { left_stringification };
-        std::vector<std::string> rstrings = { right_stringification };
+        arena_vector<arena_string> lstrings(allocator);
+        lstrings.emplace_back(left_stringification, allocator);
+        arena_vector<arena_string> rstrings(allocator);
+        rstrings.emplace_back(right_stringification, allocator);
         LIBASSERT_PRIMITIVE_DEBUG_ASSERT(!lstrings.empty());
         LIBASSERT_PRIMITIVE_DEBUG_ASSERT(!rstrings.empty());
         // pad all columns where there is overlap
         // TODO: Use column printer instead of manual padding.
         for(size_t i = 0; i < std::min(lstrings.size(), rstrings.size()); i++) {
             // find which clause, left or right, we're padding (entry i)
-            std::vector<std::string>& which = lstrings[i].length() < rstrings[i].length() ? lstrings : rstrings;
+            arena_vector<arena_string>& which = lstrings[i].length() < rstrings[i].length() ? lstrings : rstrings;
             const int difference = std::abs((int)lstrings[i].length() - (int)rstrings[i].length());
             if(i != which.size() - 1) { // last column excluded as padding is not necessary at the end of the line
                 which[i].insert(which[i].end(), difference, ' ');
@@ -264,7 +381,7 @@ namespace libassert::detail {
                 || (right_expression != rstrings[0] && trim_suffix(right_expression) != rstrings[0])
         };
         // print where clause
-        std::string where;
+        arena_string where(allocator);
         if(has_useful_where_clause.left || has_useful_where_clause.right) {
             size_t lw = std::max(
                 has_useful_where_clause.left  ? left_expression.size() : 0,
@@ -277,7 +394,7 @@ namespace libassert::detail {
             where += "    Where:\n";
             auto print_clause = [term_width, lw, &where, &scheme](
                 std::string_view expr_str,
-                const std::vector<std::string>& expr_strs
+                const arena_vector<arena_string>& expr_strs
             ) {
                 if(term_width >= min_term_width) {
                     where += wrapped_print(
@@ -307,16 +424,25 @@ namespace libassert::detail {
                 print_clause(right_expression, rstrings);
             }
         }
+        if(!range_differences.empty()) {
+            where += "    Differences:\n";
+            for(const auto& difference : range_differences) {
+                where += "        ";
+                where += detail::highlight(difference, scheme);
+                where += "\n";
+            }
+        }
         return where;
     }
 
     LIBASSERT_ATTR_COLD [[nodiscard]]
-    std::string print_extra_diagnostics(
-        const std::vector<extra_diagnostic>& extra_diagnostics,
+    arena_string print_extra_diagnostics(
+        const arena_vector<extra_diagnostic>& extra_diagnostics,
         size_t term_width,
-        const color_scheme& scheme
+        const color_scheme& scheme,
+        const arena_allocator<char>& allocator
     ) {
-        std::string output = "    Extra diagnostics:\n";
+        arena_string output("    Extra diagnostics:\n", allocator);
         size_t lw = 0;
         for(const auto& entry : extra_diagnostics) {
             lw = std::max(lw, entry.expression.size());
@@ -416,11 +542,11 @@ namespace libassert {
 
     namespace detail {
         LIBASSERT_ATTR_COLD
-        std::unique_ptr<detail::path_handler> new_path_handler() {
+        std::unique_ptr<detail::path_handler> new_path_handler(monotonic_arena* arena) {
             auto mode = current_path_mode.load();
             switch(mode) {
                 case path_mode::disambiguated:
-                    return std::make_unique<disambiguating_path_handler>();
+                    return std::make_unique<disambiguating_path_handler>(arena);
                 case path_mode::basename:
                     return std::make_unique<basename_path_handler>();
                 case path_mode::full:
@@ -431,28 +557,64 @@ namespace libassert {
 
     }
 
+    namespace detail {
+        [[noreturn]] LIBASSERT_ATTR_COLD
+        void abort_after_failure(assert_type type) {
+            switch(type) {
+                case assert_type::assertion:
+                case assert_type::debug_assertion:
+                case assert_type::assumption:
+                case assert_type::panic:
+                case assert_type::unreachable:
+                    (void)fflush(stderr);
+                    std::abort();
+                    // Breaking here as debug CRT allows aborts to be ignored, if someone wants to make a debug build
+                    // of this library
+                    break;
+                default:
+                    LIBASSERT_PRIMITIVE_PANIC("Unknown assertion type in assertion failure handler");
+            }
+        }
+    }
+
     [[noreturn]] LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
     void default_failure_handler(const assertion_info& info) {
         enable_virtual_terminal_processing_if_needed(); // for terminal colors on windows
-        std::string message = info.to_string(
-            terminal_width(STDERR_FILENO),
-            isatty(STDERR_FILENO) ? get_color_scheme() : color_scheme::blank
-        );
-        std::cerr << message << std::endl;
-        switch(info.type) {
-            case assert_type::assertion:
-            case assert_type::debug_assertion:
-            case assert_type::assumption:
-            case assert_type::panic:
-            case assert_type::unreachable:
-                (void)fflush(stderr);
-                std::abort();
-                // Breaking here as debug CRT allows aborts to be ignored, if someone wants to make a debug build of
-                // this library
-                break;
-            default:
-                LIBASSERT_PRIMITIVE_PANIC("Unknown assertion type in assertion failure handler");
+        std::cerr.flush();
+        try {
+            fd_sink sink(STDERR_FILENO);
+            info.write_report(
+                sink,
+                terminal_width(STDERR_FILENO),
+                isatty(STDERR_FILENO) ? get_color_scheme() : color_scheme::blank
+            );
+            sink.write("\n");
+        } catch(const std::bad_alloc&) {
+            // trace resolution and formatting need the heap, fall back to a report that doesn't
+            detail::emergency_fail(info);
         }
+        detail::abort_after_failure(info.type);
+    }
+
+    namespace {
+        std::atomic<int> json_output_fd = stderr_fileno;
+    }
+
+    LIBASSERT_EXPORT void set_json_output_fd(int fd) {
+        json_output_fd = fd;
+    }
+
+    [[noreturn]] LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void json_failure_handler(const assertion_info& info) {
+        try {
+            // one write so records from concurrent failures don't interleave
+            std::string record = info.to_json();
+            record += '\n';
+            detail::write_fully(json_output_fd.load(), record.data(), record.size());
+        } catch(const std::bad_alloc&) {
+            detail::emergency_fail(info);
+        }
+        detail::abort_after_failure(info.type);
     }
 
     namespace detail {
@@ -473,8 +635,243 @@ namespace libassert {
     }
 
     namespace detail {
-        LIBASSERT_ATTR_COLD LIBASSERT_EXPORT void fail(const assertion_info& info) {
-            detail::get_failure_handler().load()(info);
+        LIBASSERT_ATTR_COLD LIBASSERT_EXPORT void fail(assertion_info&& info) {
+            const auto handler = detail::get_failure_handler().load();
+            if(should_defer(info, handler) && defer_failure(std::move(info), handler)) {
+                return;
+            }
+            handler(info);
+        }
+
+        namespace {
+            erased_value get_erased_value(erased_arguments args, size_t i) noexcept {
+                return {args.values[i], args.signature->vtables[i]};
+            }
+
+            // same as generate_stringification, values get their own output budget
+            LIBASSERT_ATTR_COLD
+            arena_string stringify_erased(const erased_value& value, const arena_allocator<char>& allocator) {
+                const stringification_budget_scope budget_scope(stringification_budget_scope::value);
+                return arena_string(value.vtable->stringify(value.value), allocator);
+            }
+
+            // same as process_arg
+            LIBASSERT_ATTR_COLD
+            void process_erased_arg(assertion_info& info, size_t i, sv_span args_strings, const erased_value& arg) {
+                const erased_vtable& vtable = *arg.vtable;
+                if(vtable.is_errno_type && args_strings.data[i] == errno_expansion) {
+                    const auto err = *static_cast<const strip<decltype(errno)>*>(arg.value);
+                    add_extra_diagnostic(
+                        info,
+                        "errno",
+                        arena_string(bstringf("%2d \"%s\"", err, strerror_wrapper(err).c_str()), info.get_allocator())
+                    );
+                    return;
+                }
+                if(vtable.message && i == 0) {
+                    set_message(info, vtable.message(arg.value));
+                    return;
+                }
+                add_extra_diagnostic(info, args_strings.data[i], stringify_erased(arg, info.get_allocator()));
+            }
+
+            LIBASSERT_ATTR_COLD
+            void process_erased_args(assertion_info& info, sv_span args_strings, erased_arguments args) {
+                const erased_signature& signature = *args.signature;
+                for(size_t i = 0; i < signature.arg_count; i++) {
+                    process_erased_arg(info, i, args_strings, get_erased_value(args, signature.operand_count + i));
+                }
+            }
+
+            // same as generate_binary_diagnostic
+            LIBASSERT_ATTR_COLD
+            binary_diagnostics_descriptor generate_erased_binary_diagnostic(
+                const erased_value& left,
+                const erased_value& right,
+                std::string_view left_str,
+                std::string_view right_str,
+                std::string_view op,
+                const arena_allocator<char>& allocator,
+                erased_range_diff range_diff = nullptr
+            ) {
+                const bool either_is_character = left.vtable->is_character || right.vtable->is_character;
+                const bool either_is_arithmetic = left.vtable->is_arithmetic || right.vtable->is_arithmetic;
+                const literal_format previous_format = set_literal_format(
+                    left_str,
+                    right_str,
+                    op,
+                    either_is_character && either_is_arithmetic
+                );
+                if(range_diff) {
+                    binary_diagnostics_descriptor diff;
+                    if(range_diff(left.value, right.value, left_str, right_str, allocator, diff)) {
+                        restore_literal_format(previous_format);
+                        return diff;
+                    }
+                }
+                binary_diagnostics_descriptor descriptor(
+                    left_str,
+                    right_str,
+                    stringify_erased(left, allocator),
+                    stringify_erased(right, allocator),
+                    has_multiple_formats()
+                );
+                restore_literal_format(previous_format);
+                return descriptor;
+            }
+        }
+
+        LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+        void process_assert_fail_erased(
+            const assert_static_parameters* params,
+            erased_arguments args,
+            pretty_function_name_wrapper pretty_function
+        ) {
+            // suppressed failures are only counted
+            if(should_suppress(params)) {
+                return;
+            }
+            const erased_signature& signature = *args.signature;
+            // the report and everything it refers to come out of the thread's failure arena, if there is one
+            const failure_arena_scope arena_scope;
+            // only building the report is covered, exceptions from the failure handler propagate as usual
+            std::optional<assertion_info> info;
+            try {
+                const size_t n_args = signature.arg_count;
+                LIBASSERT_PRIMITIVE_DEBUG_ASSERT(n_args < params->args_strings.size);
+                info.emplace(params, n_args, arena_scope.arena());
+                info->function = pretty_function.pretty_function;
+                {
+                    const stringification_budget_scope budget_scope(stringification_budget_scope::assertion);
+                    process_erased_args(*info, params->args_strings, args);
+                    if(signature.operand_count == 1) {
+                        static constexpr bool true_value = true;
+                        info->binary_diagnostics = generate_erased_binary_diagnostic(
+                            get_erased_value(args, 0),
+                            make_erased_operand<full_stringification>(true_value),
+                            params->expr_str,
+                            "true",
+                            "==",
+                            info->get_allocator()
+                        );
+                    } else if(signature.operand_count == 2) {
+                        if(params->decomposition.resolved) {
+                            info->binary_diagnostics = generate_erased_binary_diagnostic(
+                                get_erased_value(args, 0),
+                                get_erased_value(args, 1),
+                                params->decomposition.left,
+                                params->decomposition.right,
+                                signature.op,
+                                info->get_allocator(),
+                                signature.range_diff
+                            );
+                        } else {
+                            auto [left_expression, right_expression] = decompose_expression(params, signature.op);
+                            info->binary_diagnostics = generate_erased_binary_diagnostic(
+                                get_erased_value(args, 0),
+                                get_erased_value(args, 1),
+                                left_expression,
+                                right_expression,
+                                signature.op,
+                                info->get_allocator(),
+                                signature.range_diff
+                            );
+                        }
+                    }
+                }
+            } catch(const std::bad_alloc&) {
+                const assertion_info* built = info ? &*info : nullptr;
+                emergency_fail(params, args, pretty_function.pretty_function, signature.arg_count, built);
+            }
+            fail(std::move(*info));
+        }
+
+        LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+        void process_range_assert_fail_erased(
+            const assert_static_parameters* params,
+            const erased_range_failure& failure,
+            erased_arguments args,
+            pretty_function_name_wrapper pretty_function
+        ) {
+            if(should_suppress(params)) {
+                return;
+            }
+            const failure_arena_scope arena_scope;
+            std::optional<assertion_info> info;
+            try {
+                const size_t n_args = args.signature->arg_count;
+                LIBASSERT_PRIMITIVE_DEBUG_ASSERT(n_args < params->args_strings.size);
+                info.emplace(params, n_args, arena_scope.arena());
+                info->function = pretty_function.pretty_function;
+                {
+                    const stringification_budget_scope budget_scope(stringification_budget_scope::assertion);
+                    process_erased_args(*info, params->args_strings, args);
+                    const std::string element_expression = microfmt::format(
+                        "{}[{}]",
+                        failure.range_expression,
+                        failure.index
+                    );
+                    if(failure.bound.vtable) {
+                        info->binary_diagnostics = generate_erased_binary_diagnostic(
+                            failure.element,
+                            failure.bound,
+                            element_expression,
+                            failure.bound_expression,
+                            failure.op,
+                            info->get_allocator()
+                        );
+                    } else {
+                        static constexpr bool true_value = true;
+                        info->binary_diagnostics = generate_erased_binary_diagnostic(
+                            failure.element,
+                            make_erased_operand<full_stringification>(true_value),
+                            element_expression,
+                            "true",
+                            "==",
+                            info->get_allocator()
+                        );
+                    }
+                }
+            } catch(const std::bad_alloc&) {
+                emergency_fail(
+                    params,
+                    failure,
+                    pretty_function.pretty_function,
+                    args.signature->arg_count,
+                    info ? &*info : nullptr
+                );
+            }
+            fail(std::move(*info));
+        }
+
+        LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+        void process_panic_erased(
+            const assert_static_parameters* params,
+            erased_arguments args,
+            pretty_function_name_wrapper pretty_function
+        ) {
+            const failure_arena_scope arena_scope;
+            std::optional<assertion_info> info;
+            try {
+                const size_t n_args = args.signature->arg_count;
+                LIBASSERT_PRIMITIVE_DEBUG_ASSERT(n_args < params->args_strings.size);
+                info.emplace(params, n_args, arena_scope.arena());
+                info->function = pretty_function.pretty_function;
+                {
+                    const stringification_budget_scope budget_scope(stringification_budget_scope::assertion);
+                    process_erased_args(*info, params->args_strings, args);
+                }
+            } catch(const std::bad_alloc&) {
+                emergency_fail(
+                    params,
+                    erased_arguments{},
+                    pretty_function.pretty_function,
+                    args.signature->arg_count,
+                    info ? &*info : nullptr
+                );
+            }
+            fail(std::move(*info));
+            LIBASSERT_PRIMITIVE_PANIC("PANIC/UNREACHABLE failure handler returned");
         }
     }
 
@@ -482,15 +879,16 @@ namespace libassert {
     LIBASSERT_ATTR_COLD binary_diagnostics_descriptor::binary_diagnostics_descriptor(
         std::string_view _left_expression,
         std::string_view _right_expression,
-        std::string&& _left_stringification,
-        std::string&& _right_stringification,
+        arena_string&& _left_stringification,
+        arena_string&& _right_stringification,
         bool _multiple_formats
     ):
-        left_expression(_left_expression),
-        right_expression(_right_expression),
+        left_expression(_left_expression, _left_stringification.get_allocator()),
+        right_expression(_right_expression, _left_stringification.get_allocator()),
         left_stringification(std::move(_left_stringification)),
         right_stringification(std::move(_right_stringification)),
-        multiple_formats(_multiple_formats) {}
+        multiple_formats(_multiple_formats),
+        range_differences(left_stringification.get_allocator()) {}
     LIBASSERT_ATTR_COLD binary_diagnostics_descriptor::~binary_diagnostics_descriptor() = default;
     LIBASSERT_ATTR_COLD
     binary_diagnostics_descriptor::binary_diagnostics_descriptor(const binary_diagnostics_descriptor&) = default;
@@ -498,25 +896,89 @@ namespace libassert {
     binary_diagnostics_descriptor& binary_diagnostics_descriptor::operator=(const binary_diagnostics_descriptor&) = default;
     LIBASSERT_ATTR_COLD binary_diagnostics_descriptor&
     binary_diagnostics_descriptor::operator=(binary_diagnostics_descriptor&&) noexcept(LIBASSERT_GCC_ISNT_STUPID) = default;
+
+    LIBASSERT_ATTR_COLD void binary_diagnostics_descriptor::add_range_difference(std::string_view difference) {
+        range_differences.emplace_back(difference, left_stringification.get_allocator());
+    }
+
+    namespace detail {
+        LIBASSERT_ATTR_COLD void set_message(assertion_info& info, std::string_view message) {
+            info.message.emplace(message, info.get_allocator());
+        }
+
+        LIBASSERT_ATTR_COLD void add_extra_diagnostic(
+            assertion_info& info,
+            std::string_view expression,
+            arena_string&& stringification
+        ) {
+            info.extra_diagnostics.push_back({ expression, std::move(stringification) });
+        }
+    }
 }
 
 namespace libassert {
     using namespace detail;
 
+    namespace {
+        // the most frames captured into a failure arena, deeper traces go on the heap
+        constexpr std::size_t max_arena_trace_frames = 256;
+
+        // Moves a member of an assertion_info, unless it's in an arena. Then it's copied to the heap, the arena is
+        // reset by the thread's next failure which whatever is moved to may well outlive.
+        template<typename T>
+        T move_out_of_arena(T& value, monotonic_arena* arena) {
+            if(arena) {
+                return value;
+            }
+            return std::move(value);
+        }
+    }
+
     LIBASSERT_ATTR_COLD assertion_info::assertion_info(
-        const assert_static_parameters* static_params,
+        const assert_static_parameters* _static_params,
         cpptrace::raw_trace&& _raw_trace,
         size_t _n_args
     ) :
-        macro_name(static_params->macro_name),
-        type(static_params->type),
-        expression_string(static_params->expr_str),
-        file_name(static_params->location.file),
-        line(static_params->location.line),
+        macro_name(_static_params->macro_name),
+        type(_static_params->type),
+        expression_string(_static_params->expr_str),
+        file_name(_static_params->location.file),
+        line(_static_params->location.line),
         function("<error>"),
         n_args(_n_args),
+        static_params(_static_params),
+        arena(nullptr),
         trace(std::move(_raw_trace)) {}
 
+    LIBASSERT_ATTR_COLD assertion_info::assertion_info(
+        const assert_static_parameters* _static_params,
+        size_t _n_args,
+        monotonic_arena* _arena
+    ) :
+        macro_name(_static_params->macro_name),
+        type(_static_params->type),
+        expression_string(_static_params->expr_str),
+        file_name(_static_params->location.file),
+        line(_static_params->location.line),
+        function("<error>"),
+        extra_diagnostics(allocator_type(_arena)),
+        n_args(_n_args),
+        static_params(_static_params),
+        arena(_arena) {
+        if(arena) {
+            // raw_trace would put the frames on the heap
+            arena_vector<cpptrace::frame_ptr> frames(max_arena_trace_frames, allocator_type(arena));
+            const std::size_t count = cpptrace::safe_generate_raw_trace(frames.data(), frames.size());
+            // 0 if unwinding into a buffer isn't supported, and a full buffer may have cut the trace short
+            if(count != 0 && count < frames.size()) {
+                frames.resize(count);
+                trace = std::move(frames);
+                return;
+            }
+        }
+        trace = cpptrace::generate_raw_trace();
+    }
+
     LIBASSERT_ATTR_COLD assertion_info::~assertion_info() = default;
     assertion_info::assertion_info(const assertion_info& other) :
         macro_name(other.macro_name),
@@ -529,30 +991,65 @@ namespace libassert {
         binary_diagnostics(other.binary_diagnostics),
         extra_diagnostics(other.extra_diagnostics),
         n_args(other.n_args),
+        static_params(other.static_params),
+        arena(nullptr),
         trace(other.trace),
         path_handler(other.path_handler ? other.path_handler->clone() : nullptr)
         {}
-    assertion_info::assertion_info(assertion_info&&) = default;
+    assertion_info::assertion_info(assertion_info&& other) :
+        macro_name(other.macro_name),
+        type(other.type),
+        expression_string(other.expression_string),
+        file_name(other.file_name),
+        line(other.line),
+        function(other.function),
+        message(move_out_of_arena(other.message, other.arena)),
+        binary_diagnostics(move_out_of_arena(other.binary_diagnostics, other.arena)),
+        extra_diagnostics(move_out_of_arena(other.extra_diagnostics, other.arena)),
+        n_args(other.n_args),
+        static_params(other.static_params),
+        arena(nullptr),
+        trace(move_out_of_arena(other.trace, other.arena)),
+        path_handler(
+            other.arena
+                ? (other.path_handler ? other.path_handler->clone() : nullptr)
+                : std::move(other.path_handler)
+        )
+        {}
     assertion_info& assertion_info::operator=(const assertion_info& other) {
+        // containers don't take the other's allocator on copy assignment, this way everything ends up on the heap
+        return *this = assertion_info(other);
+    }
+    assertion_info& assertion_info::operator=(assertion_info&& other) {
+        if(other.arena) {
+            // the arena is reset by the thread's next failure, which this may well outlive
+            return *this = assertion_info(other);
+        }
         macro_name = other.macro_name;
         type = other.type;
         expression_string = other.expression_string;
         file_name = other.file_name;
         line = other.line;
         function = other.function;
-        message = other.message;
-        binary_diagnostics = other.binary_diagnostics;
-        extra_diagnostics = other.extra_diagnostics;
+        message = std::move(other.message);
+        binary_diagnostics = std::move(other.binary_diagnostics);
+        extra_diagnostics = std::move(other.extra_diagnostics);
         n_args = other.n_args;
-        trace = other.trace;
-        path_handler = other.path_handler ? other.path_handler->clone() : nullptr;
+        static_params = other.static_params;
+        arena = nullptr;
+        trace = std::move(other.trace);
+        path_handler = std::move(other.path_handler);
         return *this;
     }
-    assertion_info& assertion_info::operator=(assertion_info&&) = default;
+
+    assertion_info::allocator_type assertion_info::get_allocator() const noexcept {
+        return allocator_type(arena);
+    }
 
     path_handler* assertion_info::get_path_handler() const {
         if(!path_handler) {
-            path_handler = new_path_handler();
+            // only the assertion_info built for the failure has an arena, copies and their handlers never refer to it
+            path_handler = new_path_handler(arena);
             // if this is a disambiguating handler or similar it needs to be fed all paths
             if(path_handler->has_add_path()) {
                 path_handler->add_path(file_name);
@@ -566,6 +1063,15 @@ namespace libassert {
         return path_handler.get();
     }
 
+    std::string_view assertion_info::header_file_name() const {
+        // disambiguation needs every path in the resolved trace, the header is written before resolving it and makes do
+        // with the file name
+        if(current_path_mode.load() == path_mode::full) {
+            return file_name;
+        }
+        return basename_path_handler().resolve_path(file_name);
+    }
+
     LIBASSERT_ATTR_COLD std::string_view assertion_info::action() const {
         switch(type) {
             case assert_type::debug_assertion: return "Debug Assertion failed";
@@ -579,6 +1085,11 @@ namespace libassert {
     }
 
     LIBASSERT_ATTR_COLD const cpptrace::raw_trace& assertion_info::get_raw_trace() const {
+        if(const auto* frames = std::get_if<arena_vector<cpptrace::frame_ptr>>(&trace)) {
+            cpptrace::raw_trace raw_trace;
+            raw_trace.frames.assign(frames->begin(), frames->end());
+            trace = std::move(raw_trace);
+        }
         try {
             return std::get<cpptrace::raw_trace>(trace);
         } catch(std::bad_variant_access&) {
@@ -587,10 +1098,10 @@ namespace libassert {
     }
 
     LIBASSERT_ATTR_COLD const cpptrace::stacktrace& assertion_info::get_stacktrace() const {
-        if(trace.index() == 0) {
-            // do resolution
-            auto raw_trace = std::move(std::get<cpptrace::raw_trace>(trace));
-            trace = raw_trace.resolve();
+        if(const auto* raw_trace = std::get_if<cpptrace::raw_trace>(&trace)) {
+            trace = resolve_cached(*raw_trace);
+        } else if(const auto* frames = std::get_if<arena_vector<cpptrace::frame_ptr>>(&trace)) {
+            trace = resolve_cached(frames->data(), frames->size());
         }
         return std::get<cpptrace::stacktrace>(trace);
     }
@@ -603,35 +1114,42 @@ namespace libassert {
     }
 
     std::string assertion_info::tagline(const color_scheme& scheme) const {
-        const auto prettified_function = prettify_type(std::string(function));
+        std::string output;
+        detail::string_sink sink(output);
+        write_tagline(sink, scheme);
+        return output;
+    }
+
+    void assertion_info::write_tagline(report_sink& sink, const color_scheme& scheme) const {
+        // written piecewise to avoid building it up
+        const auto highlighted_function = highlight_site_text(static_params, site_text::function, function, scheme);
+        char line_number[12];
+        const auto line_end = std::to_chars(line_number, line_number + sizeof(line_number), line).ptr;
+        sink.write(action());
+        sink.write(" at ");
+        sink.write(header_file_name());
+        sink.write(":");
+        sink.write({line_number, static_cast<std::size_t>(line_end - line_number)});
+        sink.write(": ");
+        sink.write(highlighted_function);
+        sink.write(":");
         if(message && !message->empty()) {
-            return microfmt::format(
-                "{} at {}:{}: {}: {}\n",
-                action(),
-                get_path_handler()->resolve_path(file_name),
-                line,
-                detail::highlight(prettified_function, scheme),
-                *message
-            );
-        } else {
-            return microfmt::format(
-                "{} at {}:{}: {}:\n",
-                action(),
-                get_path_handler()->resolve_path(file_name),
-                line,
-                detail::highlight(prettified_function, scheme)
-            );
+            sink.write(" ");
+            sink.write(*message);
         }
+        sink.write("\n");
     }
 
     std::string assertion_info::location() const {
-        return microfmt::format("{}:{}", get_path_handler()->resolve_path(file_name), line);
+        return microfmt::format("{}:{}", header_file_name(), line);
     }
 
     std::string assertion_info::statement(const color_scheme& scheme) const {
         return microfmt::format(
             "    {}\n",
-            detail::highlight(
+            highlight_site_text(
+                static_params,
+                n_args > 0 ? site_text::statement_with_args : site_text::statement,
                 microfmt::format(
                     "{}({}{});",
                     macro_name,
@@ -645,7 +1163,7 @@ namespace libassert {
 
     std::string assertion_info::print_binary_diagnostics(int width, const color_scheme& scheme) const {
         if(binary_diagnostics) {
-            return libassert::detail::print_binary_diagnostics(*binary_diagnostics, width, scheme);
+            return std::string(libassert::detail::print_binary_diagnostics(*binary_diagnostics, width, scheme, {}));
         } else {
             return "";
         }
@@ -653,7 +1171,7 @@ namespace libassert {
 
     std::string assertion_info::print_extra_diagnostics(int width, const color_scheme& scheme) const {
         if(!extra_diagnostics.empty()) {
-            return libassert::detail::print_extra_diagnostics(extra_diagnostics, width, scheme);
+            return std::string(libassert::detail::print_extra_diagnostics(extra_diagnostics, width, scheme, {}));
         } else {
             return "";
         }
@@ -665,19 +1183,102 @@ namespace libassert {
     }
 
     LIBASSERT_ATTR_COLD std::string assertion_info::to_string(int width, const color_scheme& scheme) const {
-        // auto& stacktrace = get_stacktrace(); // TODO
-        // now do output
         std::string output;
-        // generate statement
-        output += tagline(scheme);
-        output += statement(scheme);
-        output += print_binary_diagnostics(width, scheme);
-        output += print_extra_diagnostics(width, scheme);
-        // generate stack trace
-        output += "\nStack trace:\n";
-        output += print_stacktrace(width, scheme);
+        detail::string_sink sink(output);
+        write_report(sink, width, scheme);
         return output;
     }
+
+    LIBASSERT_ATTR_COLD std::string assertion_info::to_json() const {
+        std::string output;
+        detail::string_sink sink(output);
+        write_json(sink);
+        return output;
+    }
+
+    LIBASSERT_ATTR_COLD void assertion_info::write_json(report_sink& sink) const {
+        using namespace detail;
+        sink.write("{\"type\":");
+        write_json_string(sink, assert_type_name(type));
+        sink.write(",\"macro\":");
+        write_json_string(sink, macro_name);
+        sink.write(",\"file\":");
+        write_json_string(sink, file_name);
+        sink.write(",\"line\":");
+        write_json_number(sink, line);
+        sink.write(",\"function\":");
+        write_json_string(sink, function);
+        sink.write(",\"expression\":");
+        write_json_string(sink, expression_string);
+        sink.write(",\"message\":");
+        if(message) {
+            write_json_string(sink, *message);
+        } else {
+            sink.write("null");
+        }
+        if(binary_diagnostics) {
+            sink.write(",\"left\":");
+            write_json_expression_value(
+                sink,
+                binary_diagnostics->left_expression,
+                binary_diagnostics->left_stringification
+            );
+            sink.write(",\"right\":");
+            write_json_expression_value(
+                sink,
+                binary_diagnostics->right_expression,
+                binary_diagnostics->right_stringification
+            );
+        } else {
+            sink.write(",\"left\":null,\"right\":null");
+        }
+        sink.write(",\"differences\":[");
+        if(binary_diagnostics) {
+            for(const auto& difference : binary_diagnostics->range_differences) {
+                if(&difference != &binary_diagnostics->range_differences.front()) {
+                    sink.write(",");
+                }
+                write_json_string(sink, difference);
+            }
+        }
+        sink.write("]");
+        sink.write(",\"extra\":[");
+        for(const auto& entry : extra_diagnostics) {
+            if(&entry != &extra_diagnostics.front()) {
+                sink.write(",");
+            }
+            write_json_expression_value(sink, entry.expression, entry.stringification);
+        }
+        sink.write("],\"frames\":[");
+        const auto& stacktrace = get_stacktrace();
+        if(!stacktrace.empty()) {
+            // same frames as the printed trace
+            auto [start, end] = get_trace_window(stacktrace);
+            for(std::size_t i = start; i <= end; i++) {
+                if(i != start) {
+                    sink.write(",");
+                }
+                write_json_frame(sink, stacktrace.frames[i]);
+            }
+        }
+        sink.write("]}");
+    }
+
+    LIBASSERT_ATTR_COLD
+    void assertion_info::write_report(report_sink& sink, int width, const color_scheme& scheme) const {
+        write_tagline(sink, scheme);
+        sink.write(statement(scheme));
+        if(binary_diagnostics) {
+            sink.write(libassert::detail::print_binary_diagnostics(*binary_diagnostics, width, scheme, get_allocator()));
+        }
+        if(!extra_diagnostics.empty()) {
+            sink.write(libassert::detail::print_extra_diagnostics(extra_diagnostics, width, scheme, get_allocator()));
+        }
+        sink.write("\nStack trace:\n");
+        // everything so far can go out before the trace is resolved
+        sink.flush();
+        libassert::detail::print_stacktrace(get_stacktrace(), width, scheme, get_path_handler(), sink);
+    }
 }
 
 namespace libassert {
@@ -0,0 +1,205 @@
+#include "deferred_reporting.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "common.hpp"
+
+namespace libassert::detail {
+    namespace {
+        std::atomic<reporting_mode> current_reporting_mode = reporting_mode::synchronous;
+        std::atomic<bool> reporter_alive = false;
+
+        // Bounded multi-producer single-consumer ring buffer, the scheme is Dmitry Vyukov's bounded queue. Producers
+        // claim a slot with a CAS on the tail, move the failure into it, and publish it by bumping the slot's sequence
+        // number, the reporter thread is the only consumer. Slots are allocated once up front. Failures built in a
+        // failure arena are copied out of it instead, the arena is reused once the failing thread moves on.
+        class deferred_reporter {
+            struct slot {
+                std::atomic<std::size_t> sequence;
+                handler_ptr handler = nullptr;
+                std::optional<assertion_info> info;
+            };
+            static constexpr std::size_t capacity = 1024; // must be a power of two
+            std::unique_ptr<slot[]> slots; // NOLINT(*-avoid-c-arrays)
+            std::atomic<std::size_t> tail = 0;
+            std::size_t head = 0; // only touched by the reporter thread
+            std::atomic<std::size_t> enqueued = 0;
+            std::atomic<std::size_t> completed = 0;
+            std::atomic<bool> stopping = false;
+            std::mutex mutex;
+            std::condition_variable wake; // producers -> reporter
+            std::condition_variable done; // reporter -> flush
+            std::thread thread;
+
+            bool ready() const {
+                return slots[head & (capacity - 1)].sequence.load(std::memory_order_acquire) == head + 1;
+            }
+
+            bool pop(slot*& out) {
+                if(!ready()) {
+                    return false;
+                }
+                out = &slots[head & (capacity - 1)];
+                return true;
+            }
+
+            void release(slot& s) {
+                s.info.reset();
+                s.sequence.store(head + capacity, std::memory_order_release);
+                head++;
+            }
+
+            void run() {
+                while(true) {
+                    slot* s = nullptr;
+                    if(pop(s)) {
+                        // the slot is ours until it's released, the handler can use it in place
+                        if(s->info) {
+                            try {
+                                // resolve here so the failing thread never pays for symbolization
+                                (void)s->info->get_stacktrace();
+                                s->handler(*s->info);
+                            } catch(...) {
+                                // nowhere to propagate to, the failing thread has moved on
+                            }
+                            completed.fetch_add(1, std::memory_order_acq_rel);
+                        }
+                        release(*s);
+                        {
+                            const std::unique_lock lock(mutex);
+                        }
+                        done.notify_all();
+                        continue;
+                    }
+                    std::unique_lock lock(mutex);
+                    if(stopping.load() && tail.load() == head) {
+                        break;
+                    }
+                    // producers publish before taking the lock to notify, so a slot published after this check
+                    // can't be missed
+                    wake.wait(lock, [this] { return ready() || stopping.load(); });
+                }
+            }
+
+        public:
+            deferred_reporter() : slots(new slot[capacity]) {
+                for(std::size_t i = 0; i < capacity; i++) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                thread = std::thread([this] { run(); });
+                reporter_alive = true;
+            }
+
+            ~deferred_reporter() {
+                // anything failing from here on is handled synchronously, then drain what's left
+                current_reporting_mode = reporting_mode::synchronous;
+                {
+                    const std::lock_guard lock(mutex);
+                    stopping = true;
+                }
+                wake.notify_one();
+                thread.join();
+                reporter_alive = false;
+            }
+
+            deferred_reporter(const deferred_reporter&) = delete;
+            deferred_reporter(deferred_reporter&&) = delete;
+            deferred_reporter& operator=(const deferred_reporter&) = delete;
+            deferred_reporter& operator=(deferred_reporter&&) = delete;
+
+            bool push(assertion_info&& info, handler_ptr handler) {
+                std::size_t pos = tail.load(std::memory_order_relaxed);
+                slot* s = nullptr;
+                while(true) {
+                    s = &slots[pos & (capacity - 1)];
+                    const std::size_t sequence = s->sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+                    if(diff == 0) {
+                        if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if(diff < 0) {
+                        return false; // full
+                    } else {
+                        pos = tail.load(std::memory_order_relaxed);
+                    }
+                }
+                bool ok = true;
+                try {
+                    s->handler = handler;
+                    s->info.emplace(std::move(info));
+                } catch(...) {
+                    // the slot has been claimed so it must still be published, the reporter skips empty slots
+                    s->info.reset();
+                    ok = false;
+                }
+                if(ok) {
+                    enqueued.fetch_add(1, std::memory_order_acq_rel);
+                }
+                s->sequence.store(pos + 1, std::memory_order_release);
+                {
+                    const std::lock_guard lock(mutex);
+                }
+                wake.notify_one();
+                return ok;
+            }
+
+            void flush() {
+                if(std::this_thread::get_id() == thread.get_id()) {
+                    return; // called from a handler, waiting would deadlock
+                }
+                const std::size_t target = enqueued.load();
+                std::unique_lock lock(mutex);
+                done.wait(lock, [&] { return completed.load() >= target; });
+            }
+        };
+
+        deferred_reporter& get_reporter() {
+            static deferred_reporter reporter;
+            return reporter;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD
+    bool should_defer(const assertion_info& info, handler_ptr handler) {
+        if(current_reporting_mode.load(std::memory_order_relaxed) != reporting_mode::deferred) {
+            return false;
+        }
+        // The built-in handlers abort, deferring them would let the program run past the failure. Handlers must not
+        // return for panic and unreachable so those are always handled in place.
+        return handler != default_failure_handler
+            && handler != json_failure_handler
+            && info.type != assert_type::panic
+            && info.type != assert_type::unreachable;
+    }
+
+    LIBASSERT_ATTR_COLD
+    bool defer_failure(assertion_info&& info, handler_ptr handler) {
+        return get_reporter().push(std::move(info), handler);
+    }
+}
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void set_reporting_mode(reporting_mode mode) {
+        if(mode == reporting_mode::deferred) {
+            (void)detail::get_reporter(); // start the reporter thread now rather than on the first failure
+        }
+        detail::current_reporting_mode = mode;
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void flush_deferred_reports() {
+        if(detail::reporter_alive) {
+            detail::get_reporter().flush();
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef DEFERRED_REPORTING_HPP
+#define DEFERRED_REPORTING_HPP
+
+#include <libassert/assert.hpp>
+
+namespace libassert::detail {
+    // Returns true if the failure should be handed to the background reporter rather than handled on this thread
+    LIBASSERT_ATTR_COLD
+    bool should_defer(const assertion_info& info, handler_ptr handler);
+
+    // Moves the failure into a slot of the background reporter's queue. Returns false if it couldn't be queued, e.g.
+    // because the queue is full, in which case info is left as is and the caller should handle the failure
+    // synchronously.
+    LIBASSERT_ATTR_COLD
+    bool defer_failure(assertion_info&& info, handler_ptr handler);
+}
+
+#endif
@@ -0,0 +1,305 @@
+#include "platform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#if defined(__has_include) && __has_include(<cpptrace/basic.hpp>)
+ #include <cpptrace/basic.hpp>
+#else
+ #include <cpptrace/cpptrace.hpp>
+#endif
+
+#include "common.hpp"
+#include "emergency.hpp"
+
+// Nothing in here may allocate, take locks, or touch stdio: this runs when the heap is already in a bad way and must
+// stay async-signal-safe.
+
+namespace libassert::detail {
+    namespace {
+        constexpr std::size_t emergency_arena_size = 4096;
+        constexpr std::size_t max_emergency_frames = 128;
+        constexpr std::size_t max_c_string_length = 256;
+
+        char emergency_arena[emergency_arena_size];
+        cpptrace::frame_ptr emergency_frames[max_emergency_frames];
+        std::atomic_flag emergency_arena_in_use = ATOMIC_FLAG_INIT;
+
+        // buffers output in the static arena, flushing to stderr as it fills
+        class emergency_writer {
+            std::size_t used = 0;
+        public:
+            void write(std::string_view str) noexcept {
+                while(!str.empty()) {
+                    if(used == emergency_arena_size) {
+                        flush();
+                    }
+                    const std::size_t count = std::min(str.size(), emergency_arena_size - used);
+                    std::memcpy(emergency_arena + used, str.data(), count);
+                    used += count;
+                    str.remove_prefix(count);
+                }
+            }
+
+            template<typename T>
+            void write_number(T value, int base = 10) noexcept {
+                char buffer[24];
+                const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value, base).ptr;
+                write({buffer, static_cast<std::size_t>(end - buffer)});
+            }
+
+            void flush() noexcept {
+                write_fully(STDERR_FILENO, emergency_arena, used);
+                used = 0;
+            }
+        };
+
+        std::string_view emergency_action(assert_type type) noexcept {
+            switch(type) {
+                case assert_type::debug_assertion: return "Debug Assertion failed";
+                case assert_type::assertion:       return "Assertion failed";
+                case assert_type::assumption:      return "Assumption failed";
+                case assert_type::panic:           return "Panic";
+                case assert_type::unreachable:     return "Unreachable reached";
+                default:
+                    return "Unknown assertion";
+            }
+        }
+
+        void write_emergency_value(emergency_writer& writer, const emergency_value& value) noexcept {
+            using kind = emergency_value::kind;
+            switch(value.value_kind) {
+                case kind::boolean:
+                    writer.write(value.unsigned_value ? "true" : "false");
+                    break;
+                case kind::character:
+                    if(value.unsigned_value >= 0x20 && value.unsigned_value < 0x7f) {
+                        const char c[] = { '\'', static_cast<char>(value.unsigned_value), '\'' };
+                        writer.write({c, sizeof(c)});
+                    } else {
+                        writer.write_number(value.unsigned_value);
+                    }
+                    break;
+                case kind::signed_integer:
+                    writer.write_number(value.signed_value);
+                    break;
+                case kind::unsigned_integer:
+                    writer.write_number(value.unsigned_value);
+                    break;
+                case kind::pointer:
+                    if(value.pointer == nullptr) {
+                        writer.write("nullptr");
+                    } else {
+                        writer.write("0x");
+                        writer.write_number(reinterpret_cast<std::uintptr_t>(value.pointer), 16);
+                    }
+                    break;
+                case kind::c_string:
+                    if(value.pointer == nullptr) {
+                        writer.write("nullptr");
+                    } else {
+                        const auto* str = static_cast<const char*>(value.pointer);
+                        std::size_t length = 0;
+                        while(length < max_c_string_length && str[length] != 0) {
+                            length++;
+                        }
+                        writer.write("\"");
+                        writer.write({str, length});
+                        writer.write(str[length] == 0 ? "\"" : "\"...");
+                    }
+                    break;
+                case kind::unavailable:
+                default:
+                    writer.write("<unavailable>");
+            }
+        }
+
+        // one report at a time, anyone else waits for it to finish and then aborts. The spin is bounded in case this is
+        // reentered from a signal handler on the same thread.
+        void acquire_emergency_arena() noexcept {
+            bool have_arena = false;
+            for(int i = 0; i < (1 << 20) && !have_arena; i++) {
+                have_arena = !emergency_arena_in_use.test_and_set(std::memory_order_acquire);
+            }
+            if(!have_arena) {
+                std::abort();
+            }
+        }
+
+        void write_statement(
+            emergency_writer& writer,
+            const assert_static_parameters* params,
+            const char* function,
+            std::size_t n_args,
+            const assertion_info* info
+        ) noexcept {
+            writer.write(emergency_action(params->type));
+            writer.write(" at ");
+            writer.write(params->location.file);
+            writer.write(":");
+            writer.write_number(params->location.line);
+            if(function) {
+                writer.write(": ");
+                writer.write(function);
+            }
+            writer.write(":");
+            if(info && info->message && !info->message->empty()) {
+                writer.write(" ");
+                writer.write(*info->message);
+            }
+            writer.write("\n    ");
+            writer.write(params->macro_name);
+            writer.write("(");
+            writer.write(params->expr_str);
+            if(n_args > 0) {
+                writer.write(params->expr_str.empty() ? "..." : ", ...");
+            }
+            writer.write(");\n");
+        }
+
+        void write_clause(emergency_writer& writer, std::string_view expression, std::string_view value) noexcept {
+            writer.write("        ");
+            writer.write(expression);
+            writer.write(" => ");
+            writer.write(value);
+            writer.write("\n");
+        }
+
+        void write_operand(
+            emergency_writer& writer,
+            std::string_view expression,
+            const emergency_value& value
+        ) noexcept {
+            writer.write("        ");
+            writer.write(expression);
+            writer.write(" => ");
+            write_emergency_value(writer, value);
+            writer.write("\n");
+        }
+
+        // what was stringified before the allocation failed
+        void write_binary_diagnostics(
+            emergency_writer& writer,
+            const binary_diagnostics_descriptor& diagnostics
+        ) noexcept {
+            const bool left = diagnostics.left_expression != diagnostics.left_stringification;
+            const bool right = diagnostics.right_expression != diagnostics.right_stringification;
+            if(left || right) {
+                writer.write("    Where:\n");
+                if(left) {
+                    write_clause(writer, diagnostics.left_expression, diagnostics.left_stringification);
+                }
+                if(right) {
+                    write_clause(writer, diagnostics.right_expression, diagnostics.right_stringification);
+                }
+            }
+            if(!diagnostics.range_differences.empty()) {
+                writer.write("    Differences:\n");
+                for(const auto& difference : diagnostics.range_differences) {
+                    writer.write("        ");
+                    writer.write(difference);
+                    writer.write("\n");
+                }
+            }
+        }
+
+        void write_extra_diagnostics(emergency_writer& writer, const assertion_info* info) noexcept {
+            if(info && !info->extra_diagnostics.empty()) {
+                writer.write("    Extra diagnostics:\n");
+                for(const auto& entry : info->extra_diagnostics) {
+                    write_clause(writer, entry.expression, entry.stringification);
+                }
+            }
+        }
+
+        [[noreturn]] void write_trace_and_abort(emergency_writer& writer) noexcept {
+            writer.write("(memory allocation failed while reporting, this is a reduced report)\n\nRaw stack trace:\n");
+            const std::size_t n_frames = cpptrace::safe_generate_raw_trace(emergency_frames, max_emergency_frames);
+            for(std::size_t i = 0; i < n_frames; i++) {
+                writer.write("#");
+                writer.write_number(i + 1);
+                writer.write(" 0x");
+                writer.write_number(emergency_frames[i], 16);
+                writer.write("\n");
+            }
+            writer.flush();
+            std::abort();
+        }
+    }
+
+    [[noreturn]] LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void emergency_fail(
+        const assert_static_parameters* params,
+        erased_arguments args,
+        const char* function,
+        std::size_t n_args,
+        const assertion_info* info
+    ) noexcept {
+        acquire_emergency_arena();
+        emergency_writer writer;
+        write_statement(writer, params, function, n_args, info);
+        if(info && info->binary_diagnostics) {
+            write_binary_diagnostics(writer, *info->binary_diagnostics);
+        } else if(args.signature && args.signature->operand_count > 0) {
+            // the operands weren't stringified, only values that don't need allocating are shown
+            const erased_signature& signature = *args.signature;
+            writer.write("    Where:\n");
+            for(std::size_t i = 0; i < signature.operand_count; i++) {
+                std::string_view expression;
+                if(signature.operand_count == 1) {
+                    expression = params->expr_str;
+                } else if(params->decomposition.resolved) {
+                    expression = i == 0 ? params->decomposition.left : params->decomposition.right;
+                } else {
+                    expression = i == 0 ? "<left operand>" : "<right operand>";
+                }
+                write_operand(writer, expression, signature.vtables[i]->emergency(args.values[i]));
+            }
+        }
+        write_extra_diagnostics(writer, info);
+        write_trace_and_abort(writer);
+    }
+
+    [[noreturn]] LIBASSERT_ATTR_COLD
+    void emergency_fail(
+        const assert_static_parameters* params,
+        const erased_range_failure& failure,
+        const char* function,
+        std::size_t n_args,
+        const assertion_info* info
+    ) noexcept {
+        acquire_emergency_arena();
+        emergency_writer writer;
+        write_statement(writer, params, function, n_args, info);
+        if(info && info->binary_diagnostics) {
+            write_binary_diagnostics(writer, *info->binary_diagnostics);
+        } else {
+            // range[index] is written piecewise since it can't be built
+            writer.write("    Where:\n        ");
+            writer.write(failure.range_expression);
+            writer.write("[");
+            writer.write_number(failure.index);
+            writer.write("] => ");
+            write_emergency_value(writer, failure.element.vtable->emergency(failure.element.value));
+            writer.write("\n");
+            if(failure.bound.vtable) {
+                write_operand(writer, failure.bound_expression, failure.bound.vtable->emergency(failure.bound.value));
+            }
+        }
+        write_extra_diagnostics(writer, info);
+        write_trace_and_abort(writer);
+    }
+
+    [[noreturn]] LIBASSERT_ATTR_COLD
+    void emergency_fail(const assertion_info& info) noexcept {
+        // everything was already built, only formatting it and resolving the trace failed
+        const char* function = info.function.empty() ? nullptr : info.function.data();
+        emergency_fail(info.static_params, erased_arguments{nullptr, nullptr}, function, info.n_args, &info);
+    }
+}
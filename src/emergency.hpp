@@ -0,0 +1,18 @@
+#ifndef EMERGENCY_HPP
+#define EMERGENCY_HPP
+
+#include <libassert/assert.hpp>
+
+namespace libassert::detail {
+    // emergency_fail for a range assertion, the failing element is shown as range[index] if it wasn't stringified
+    [[noreturn]] LIBASSERT_ATTR_COLD
+    void emergency_fail(
+        const assert_static_parameters* params,
+        const erased_range_failure& failure,
+        const char* function,
+        std::size_t n_args,
+        const assertion_info* info
+    ) noexcept;
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef ESCAPE_HPP
+#define ESCAPE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <libassert/platform.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define LIBASSERT_ESCAPE_X86 1
+ #include <immintrin.h>
+ #if LIBASSERT_IS_MSVC
+  #include <intrin.h>
+ #endif
+#else
+ #define LIBASSERT_ESCAPE_X86 0
+#endif
+
+#if LIBASSERT_ESCAPE_X86 && (LIBASSERT_IS_GCC || LIBASSERT_IS_CLANG)
+ #define LIBASSERT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+ #define LIBASSERT_TARGET_AVX2
+#endif
+
+// Internal header, also used by libassert-bench to compare the scanners
+
+namespace libassert::detail {
+    // String escaping is split into finding the next byte that can't be copied verbatim and bulk-copying the clean run
+    // before it. The scan is vectorized on x86 since asserting on large buffers is otherwise dominated by this loop.
+    // A byte needs escaping if it's a backslash, the quote character, or outside of the printable range 32-126.
+
+    // Returns the index of the first byte at or after pos which needs escaping, or str.size()
+    using escape_scanner = std::size_t(*)(std::string_view str, std::size_t pos, char quote);
+
+    inline bool needs_escape(char c, char quote) {
+        return c == '\\' || c == quote || c < 32 || c > 126;
+    }
+
+    inline std::size_t find_escape_scalar(std::string_view str, std::size_t pos, char quote) {
+        for(; pos < str.size(); pos++) {
+            if(needs_escape(str[pos], quote)) {
+                return pos;
+            }
+        }
+        return pos;
+    }
+
+    #if LIBASSERT_ESCAPE_X86
+    inline unsigned count_trailing_zeros(unsigned mask) {
+        #if LIBASSERT_IS_MSVC
+         unsigned long index;
+         _BitScanForward(&index, mask);
+         return index;
+        #else
+         return static_cast<unsigned>(__builtin_ctz(mask));
+        #endif
+    }
+
+    inline std::size_t find_escape_sse2(std::string_view str, std::size_t pos, char quote) {
+        const __m128i space = _mm_set1_epi8(32);
+        const __m128i del = _mm_set1_epi8(127);
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i quote_vec = _mm_set1_epi8(quote);
+        for(; pos + 16 <= str.size(); pos += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+            // signed comparison, bytes >= 128 are negative and get caught along with control characters
+            const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, backslash), _mm_cmpeq_epi8(chunk, quote_vec))
+            );
+            const auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if(mask != 0) {
+                return pos + count_trailing_zeros(mask);
+            }
+        }
+        return find_escape_scalar(str, pos, quote);
+    }
+
+    LIBASSERT_TARGET_AVX2
+    inline std::size_t find_escape_avx2(std::string_view str, std::size_t pos, char quote) {
+        const __m256i space = _mm256_set1_epi8(32);
+        const __m256i del = _mm256_set1_epi8(127);
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i quote_vec = _mm256_set1_epi8(quote);
+        for(; pos + 32 <= str.size(); pos += 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos));
+            const __m256i special = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi8(space, chunk), _mm256_cmpeq_epi8(chunk, del)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, backslash), _mm256_cmpeq_epi8(chunk, quote_vec))
+            );
+            const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+            if(mask != 0) {
+                return pos + count_trailing_zeros(mask);
+            }
+        }
+        return find_escape_sse2(str, pos, quote);
+    }
+
+    inline bool cpu_supports_avx2() {
+        #if LIBASSERT_IS_MSVC
+         int info[4];
+         __cpuid(info, 0);
+         if(info[0] < 7) {
+             return false;
+         }
+         __cpuid(info, 1);
+         // osxsave and avx, then check the os saves ymm state
+         if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+             return false;
+         }
+         __cpuidex(info, 7, 0);
+         return (info[1] & (1 << 5)) != 0;
+        #elif LIBASSERT_IS_GCC || LIBASSERT_IS_CLANG
+         return __builtin_cpu_supports("avx2");
+        #else
+         return false;
+        #endif
+    }
+    #endif
+
+    inline escape_scanner select_escape_scanner() {
+        #if LIBASSERT_ESCAPE_X86
+         return cpu_supports_avx2() ? find_escape_avx2 : find_escape_sse2;
+        #else
+         return find_escape_scalar;
+        #endif
+    }
+
+    // Appends the escaped string to out, stopping once out would grow past max_size. Returns whether all of str fit.
+    inline bool append_escaped(
+        std::string& out,
+        std::string_view str,
+        char quote,
+        escape_scanner scan,
+        std::size_t max_size = std::string::npos
+    ) {
+        constexpr const char* const hexdig = "0123456789abcdef";
+        // every byte takes at least one byte of output, so what can't fit is dropped before scanning
+        const std::size_t input_room = max_size > out.size() ? max_size - out.size() : 0;
+        const bool cut = str.size() > input_room;
+        if(cut) {
+            str = str.substr(0, input_room);
+        }
+        std::size_t pos = 0;
+        while(pos < str.size()) {
+            const std::size_t next = scan(str, pos, quote);
+            const std::size_t room = max_size > out.size() ? max_size - out.size() : 0;
+            if(next - pos > room) {
+                out.append(str.data() + pos, room);
+                return false;
+            }
+            out.append(str.data() + pos, next - pos);
+            if(next == str.size()) {
+                break;
+            }
+            const char c = str[next];
+            const bool is_hex = !(c == '\\' || c == '\t' || c == '\r' || c == '\n' || c == quote);
+            if(out.size() + (is_hex ? 4 : 2) > max_size) {
+                return false;
+            }
+            if(c == '\\') out += "\\\\";
+            else if(c == '\t') out += "\\t";
+            else if(c == '\r') out += "\\r";
+            else if(c == '\n') out += "\\n";
+            else if(c == quote) { out += '\\'; out += quote; }
+            else {
+                const auto byte = static_cast<unsigned char>(c);
+                out += "\\x";
+                out += hexdig[byte >> 4];
+                out += hexdig[byte & 0xF];
+            }
+            pos = next + 1;
+        }
+        return !cut;
+    }
+}
+
+#endif
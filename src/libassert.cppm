@@ -0,0 +1,121 @@
+// Copyright (c) 2021-2024 Jeremy Rifkin under the MIT license
+// https://github.com/jeremy-rifkin/libassert
+
+// The libassert module. Macros can't be exported from a module, so the assertion macros come from a companion header:
+//
+//     import libassert;
+//     #include <libassert/assert-macros.hpp>
+//
+// The libassert::module CMake target defines LIBASSERT_MODULE for its consumers, which the companion header uses to
+// select the full stringification.
+
+module;
+
+#include <libassert/assert.hpp>
+
+export module libassert;
+
+export namespace libassert {
+    // utilities
+    using libassert::source_location;
+    using libassert::stringifier;
+    using libassert::type_name;
+    using libassert::pretty_type_name;
+    using libassert::stringify;
+    using libassert::highlight;
+    using libassert::highlight_stringify;
+    using libassert::stacktrace;
+
+    // terminal utilities
+    using libassert::terminal_width;
+    using libassert::enable_virtual_terminal_processing_if_needed;
+    using libassert::stdin_fileno;
+    using libassert::stdout_fileno;
+    using libassert::stderr_fileno;
+    using libassert::isatty;
+    using libassert::is_debugger_present;
+    using libassert::debugger_check_mode;
+    using libassert::set_debugger_check_mode;
+
+    // configuration
+    using libassert::color_scheme;
+    using libassert::set_color_scheme;
+    using libassert::get_color_scheme;
+    using libassert::set_separator;
+    using libassert::literal_format;
+    using libassert::operator|;
+    using libassert::literal_format_mode;
+    using libassert::set_literal_format_mode;
+    using libassert::set_fixed_literal_format;
+    using libassert::path_mode;
+    using libassert::set_path_mode;
+    using libassert::set_sampling_rate;
+    using libassert::set_failure_suppression;
+    using libassert::reset_failure_suppression;
+    using libassert::set_failure_arena_size;
+    using libassert::set_stringification_budget;
+
+    // failure handling
+    using libassert::assert_type;
+    using libassert::assertion_info;
+    using libassert::arena_string;
+    using libassert::arena_vector;
+    using libassert::binary_diagnostics_descriptor;
+    using libassert::extra_diagnostic;
+    using libassert::default_failure_handler;
+    using libassert::json_failure_handler;
+    using libassert::set_json_output_fd;
+    using libassert::handler_ptr;
+    using libassert::get_failure_handler;
+    using libassert::set_failure_handler;
+    using libassert::reporting_mode;
+    using libassert::set_reporting_mode;
+    using libassert::flush_deferred_reports;
+    using libassert::report_sink;
+    using libassert::fd_sink;
+    using libassert::buffer_sink;
+    using libassert::callback_sink;
+    using libassert::site_counts;
+    using libassert::get_site_counts;
+    using libassert::reset_site_counts;
+    using libassert::write_site_counts;
+
+    using libassert::ERROR_ASSERTION_FAILURE_IN_CONSTEXPR_CONTEXT;
+}
+
+// What the assertion macros expand to
+export namespace libassert::detail {
+    using libassert::detail::expression_decomposer;
+    using libassert::detail::decomposer_op_string;
+    using libassert::detail::decompose_expression_static;
+    using libassert::detail::static_decomposition;
+    using libassert::detail::sv_span;
+    using libassert::detail::assert_static_parameters;
+    using libassert::detail::pretty_function_name_wrapper;
+    using libassert::detail::process_assert_fail;
+    using libassert::detail::process_assert_fail_m;
+    using libassert::detail::process_assert_fail_n;
+    using libassert::detail::process_panic;
+    using libassert::detail::erase_assertion;
+    using libassert::detail::full_stringification;
+    using libassert::detail::process_assert_fail_erased;
+    using libassert::detail::process_panic_erased;
+    using libassert::detail::sampling_site;
+    using libassert::detail::site_counter;
+    using libassert::detail::make_predicate_check;
+    using libassert::detail::make_bounds_check;
+    using libassert::detail::not_nan_check;
+    using libassert::detail::find_failing_element;
+    using libassert::detail::no_failing_element;
+    using libassert::detail::process_range_assert_fail;
+    using libassert::detail::get_expression_return_value;
+    using libassert::detail::always_false;
+    using libassert::detail::primitive_assert_impl;
+    using libassert::detail::primitive_panic_impl;
+    #if LIBASSERT_IS_GCC && __GNUC__ == 12 && __GNUC_MINOR__ == 1
+     using libassert::detail::destroy;
+    #endif
+    #if !(LIBASSERT_IS_CLANG || LIBASSERT_IS_GCC)
+     using libassert::detail::static_cast_to_bool;
+    #endif
+}
@@ -0,0 +1,157 @@
+#ifndef NUMBER_FORMAT_HPP
+#define NUMBER_FORMAT_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#if !defined(__cpp_lib_to_chars)
+ #include <iomanip>
+ #include <sstream>
+#endif
+
+// Internal header, also used by libassert-bench to compare against iostream formatting
+
+namespace libassert::detail {
+    // Number formatting for stringification. Everything is written to a stack buffer with std::to_chars or digit
+    // tables and then appended, output is the same as what iostreams produce with the corresponding manipulators.
+
+    // Large enough for any integer in binary and any floating point value at max_digits10
+    constexpr std::size_t number_buffer_size = 160;
+    using number_buffer = std::array<char, number_buffer_size>;
+
+    inline constexpr char binary_nibbles[16][4] = {
+        {'0','0','0','0'}, {'0','0','0','1'}, {'0','0','1','0'}, {'0','0','1','1'},
+        {'0','1','0','0'}, {'0','1','0','1'}, {'0','1','1','0'}, {'0','1','1','1'},
+        {'1','0','0','0'}, {'1','0','0','1'}, {'1','0','1','0'}, {'1','0','1','1'},
+        {'1','1','0','0'}, {'1','1','0','1'}, {'1','1','1','0'}, {'1','1','1','1'}
+    };
+
+    // "00" "01" ... "77", two octal digits per six bits
+    inline constexpr std::array<char, 128> octal_pairs = [] {
+        std::array<char, 128> pairs{};
+        for(std::size_t i = 0; i < 64; i++) {
+            pairs[2 * i] = static_cast<char>('0' + i / 8);
+            pairs[2 * i + 1] = static_cast<char>('0' + i % 8);
+        }
+        return pairs;
+    }();
+
+    template<typename T>
+    void append_decimal(std::string& out, T value) {
+        number_buffer buffer;
+        const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+        out.append(buffer.data(), result.ptr);
+    }
+
+    // Like std::showbase << std::hex: negative values print as their unsigned representation and 0 has no prefix
+    template<typename T>
+    void append_hex(std::string& out, T value) {
+        const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        if(bits != 0) {
+            out += "0x";
+        }
+        number_buffer buffer;
+        const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), bits, 16);
+        out.append(buffer.data(), result.ptr);
+    }
+
+    // Like std::showbase << std::oct: a leading 0 for nonzero values
+    template<typename T>
+    void append_octal(std::string& out, T value) {
+        auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        number_buffer buffer;
+        char* const end = buffer.data() + buffer.size();
+        char* begin = end;
+        while(bits >= 64) {
+            begin -= 2;
+            std::memcpy(begin, &octal_pairs[2 * (bits & 63)], 2);
+            bits >>= 6;
+        }
+        if(bits >= 8) {
+            begin -= 2;
+            std::memcpy(begin, &octal_pairs[2 * bits], 2);
+        } else {
+            *--begin = static_cast<char>('0' + bits);
+        }
+        if(*begin != '0') {
+            *--begin = '0';
+        }
+        out.append(begin, end);
+    }
+
+    // Like "0b" << std::bitset: always the full width of the type
+    template<typename T>
+    void append_binary(std::string& out, T value) {
+        const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        constexpr int width = std::numeric_limits<std::make_unsigned_t<T>>::digits;
+        number_buffer buffer;
+        char* it = buffer.data();
+        *it++ = '0';
+        *it++ = 'b';
+        for(int shift = width - 4; shift >= 0; shift -= 4) {
+            std::memcpy(it, binary_nibbles[(bits >> shift) & 0xF], 4);
+            it += 4;
+        }
+        out.append(buffer.data(), it);
+    }
+
+    // Like std::setprecision(max_digits10) << value, or std::hexfloat << value, and then ".0" if a finite value has no
+    // '.'
+    template<typename T>
+    void append_floating_point(std::string& out, T value, bool hex) {
+        const std::size_t start = out.size();
+        #ifdef __cpp_lib_to_chars
+         number_buffer buffer;
+         char* it = buffer.data();
+         if(hex) {
+             // to_chars doesn't emit the 0x prefix
+             if(std::signbit(value)) {
+                 *it++ = '-';
+                 value = -value;
+             }
+             if(std::isfinite(value)) {
+                 *it++ = '0';
+                 *it++ = 'x';
+             }
+         }
+         // iostreams go through printf, which formats floats as doubles
+         using hex_type = std::conditional_t<std::is_same_v<T, float>, double, T>;
+         const auto result = hex
+             ? std::to_chars(
+                 it,
+                 buffer.data() + buffer.size(),
+                 static_cast<hex_type>(value),
+                 std::chars_format::hex
+             )
+             : std::to_chars(
+                 it,
+                 buffer.data() + buffer.size(),
+                 value,
+                 std::chars_format::general,
+                 std::numeric_limits<T>::max_digits10
+             );
+         out.append(buffer.data(), result.ptr);
+        #else
+         std::ostringstream oss;
+         if(hex) {
+             oss<<std::hexfloat;
+         }
+         oss<<std::setprecision(std::numeric_limits<T>::max_digits10)<<value;
+         out += std::move(oss).str();
+        #endif
+        // std::showpoint adds a bunch of unecessary digits, so manually doing it correctly here. "inf.0" and "nan.0"
+        // would read as garbage.
+        if(std::isfinite(value) && out.find('.', start) == std::string::npos) {
+            out += ".0";
+        }
+    }
+}
+
+#endif
@@ -1,11 +1,11 @@
 #include "paths.hpp"
 
-#include "common.hpp"
+#include <algorithm>
 #include <memory>
 
-namespace libassert::detail {
-    using path_components = std::vector<std::string>;
+#include "common.hpp"
 
+namespace libassert::detail {
     #if IS_WINDOWS
      constexpr std::string_view path_delim = "/\\";
     #else
@@ -13,7 +13,7 @@ namespace libassert::detail {
     #endif
 
     LIBASSERT_ATTR_COLD
-    path_components parse_path(const std::string_view path) {
+    path_components parse_path(const std::string_view path, const arena_allocator<char>& allocator) {
         // Some cases to consider
         // projects/libassert/demo.cpp               projects   libassert  demo.cpp
         // /glibc-2.27/csu/../csu/libc-start.c  /  glibc-2.27 csu      libc-start.c
@@ -22,12 +22,15 @@ namespace libassert::detail {
         // ../x.hpp                             .. x.hpp
         // /foo/./x                                foo        x
         // /foo//x                                 f          x
-        path_components parts;
-        for(auto part : split(path, path_delim)) {
+        path_components parts(allocator);
+        for(std::size_t start = 0; start <= path.size(); ) {
+            const auto end = std::min(path.find_first_of(path_delim, start), path.size());
+            const auto part = path.substr(start, end - start);
+            start = end + 1;
             if(parts.empty()) {
                 // TODO: Maybe it could be ok to use string_view's here, have to be careful about lifetime
                 // first gets added no matter what
-                parts.emplace_back(part);
+                parts.emplace_back(part, allocator);
             } else {
                 if(part.empty()) {
                     // nop
@@ -36,12 +39,12 @@ namespace libassert::detail {
                 } else if(part == "..") {
                     // cases where we have unresolvable ..'s, e.g. ./../../demo.exe
                     if(parts.back() == "." || parts.back() == "..") {
-                        parts.emplace_back(part);
+                        parts.emplace_back(part, allocator);
                     } else {
                         parts.pop_back();
                     }
                 } else {
-                    parts.emplace_back(part);
+                    parts.emplace_back(part, allocator);
                 }
             }
         }
@@ -57,8 +60,8 @@ namespace libassert::detail {
     }
 
     LIBASSERT_ATTR_COLD
-    path_components path_trie::disambiguate(const path_components& path) {
-        path_components result;
+    arena_vector<std::string_view> path_trie::disambiguate(const path_components& path) {
+        arena_vector<std::string_view> result(edges.get_allocator());
         path_trie* current = this;
         LIBASSERT_PRIMITIVE_DEBUG_ASSERT(path.back() == root);
         result.push_back(current->root);
@@ -67,9 +70,8 @@ namespace libassert::detail {
             if(current->downstream_branches == 1) {
                 break;
             }
-            const std::string& component = path[i];
-            LIBASSERT_PRIMITIVE_DEBUG_ASSERT(current->edges.count(component));
-            current = current->edges.at(component).get();
+            current = current->find_edge(path[i]);
+            LIBASSERT_PRIMITIVE_DEBUG_ASSERT(current);
             result.push_back(current->root);
         }
         std::reverse(result.begin(), result.end());
@@ -81,15 +83,27 @@ namespace libassert::detail {
         if(i < 0) {
             return;
         }
-        if(!edges.count(path[i])) {
+        path_trie* edge = find_edge(path[i]);
+        if(!edge) {
             if(!edges.empty()) {
                 downstream_branches++; // this is to deal with making leaves have count 1
             }
-            edges.insert({path[i], std::make_unique<path_trie>(path[i])});
+            edge = &edges.emplace_back(path[i], edges.get_allocator());
         }
-        downstream_branches -= edges.at(path[i])->downstream_branches;
-        edges.at(path[i])->insert(path, i - 1);
-        downstream_branches += edges.at(path[i])->downstream_branches;
+        // edge stays valid, only its own edges are modified below
+        downstream_branches -= edge->downstream_branches;
+        edge->insert(path, i - 1);
+        downstream_branches += edge->downstream_branches;
+    }
+
+    LIBASSERT_ATTR_COLD
+    path_trie* path_trie::find_edge(std::string_view component) {
+        for(auto& edge : edges) {
+            if(edge.root == component) {
+                return &edge;
+            }
+        }
+        return nullptr;
     }
 
     bool path_handler::has_add_path() const {
@@ -114,6 +128,14 @@ namespace libassert::detail {
         return path;
     }
 
+    LIBASSERT_ATTR_COLD
+    disambiguating_path_handler::disambiguating_path_handler(monotonic_arena* arena)
+        : allocator(arena), paths(allocator), path_map(allocator) {}
+
+    LIBASSERT_ATTR_COLD
+    disambiguating_path_handler::disambiguating_path_handler(const disambiguating_path_handler& other)
+        : path_handler(other), paths(other.paths), path_map(other.path_map) {}
+
     LIBASSERT_ATTR_COLD
     std::unique_ptr<detail::path_handler> disambiguating_path_handler::clone() const {
         return std::make_unique<disambiguating_path_handler>(*this);
@@ -121,7 +143,7 @@ namespace libassert::detail {
 
     LIBASSERT_ATTR_COLD
     std::string_view disambiguating_path_handler::resolve_path(std::string_view path) {
-        return path_map.at(std::string(path));
+        return path_map.at(arena_string(path, allocator));
     }
 
     bool disambiguating_path_handler::has_add_path() const {
@@ -130,31 +152,38 @@ namespace libassert::detail {
 
     LIBASSERT_ATTR_COLD
     void disambiguating_path_handler::add_path(std::string_view path) {
-        paths.emplace_back(path);
+        paths.emplace_back(path, allocator);
     }
 
     LIBASSERT_ATTR_COLD
     void disambiguating_path_handler::finalize() {
-        // raw full path -> components
-        std::unordered_map<std::string, path_components> parsed_paths;
-        // base file name -> path trie
-        std::unordered_map<std::string, path_trie> tries;
+        // raw full path -> components, keys refer to paths
+        arena_unordered_map<std::string_view, path_components> parsed_paths(allocator);
+        // base file name -> path trie, keys refer to the components in parsed_paths
+        arena_unordered_map<std::string_view, path_trie> tries(allocator);
         for(const auto& path : paths) {
             if(!parsed_paths.count(path)) {
-                auto parsed_path = parse_path(path);
-                auto& file_name = parsed_path.back();
-                parsed_paths.insert({path, parsed_path});
-                if(tries.count(file_name) == 0) {
-                    tries.insert({file_name, path_trie(file_name)});
+                const auto& parsed_path = parsed_paths.emplace(path, parse_path(path, allocator)).first->second;
+                const std::string_view file_name = parsed_path.back();
+                auto it = tries.find(file_name);
+                if(it == tries.end()) {
+                    it = tries.emplace(file_name, path_trie(file_name, allocator)).first;
                 }
-                tries.at(file_name).insert(parsed_path);
+                it->second.insert(parsed_path);
             }
         }
         // raw full path -> minified path
-        std::unordered_map<std::string, std::string> files;
+        arena_string_map<arena_string> files(allocator);
         for(auto& [raw, parsed_path] : parsed_paths) {
-            const std::string new_path = join(tries.at(parsed_path.back()).disambiguate(parsed_path), "/");
-            LIBASSERT_PRIMITIVE_ASSERT(files.insert({raw, new_path}).second);
+            const auto components = tries.at(parsed_path.back()).disambiguate(parsed_path);
+            arena_string new_path(allocator);
+            for(std::size_t i = 0; i < components.size(); i++) {
+                if(i > 0) {
+                    new_path += '/';
+                }
+                new_path += components[i];
+            }
+            LIBASSERT_PRIMITIVE_ASSERT(files.emplace(arena_string(raw, allocator), std::move(new_path)).second);
         }
         path_map = std::move(files);
         // return {files, std::min(longest_file_width, size_t(50))};
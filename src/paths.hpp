@@ -2,19 +2,19 @@
 #define PATHS_HPP
 
 #include <string_view>
-#include <string>
-#include <unordered_map>
-#include <vector>
 
+#include "arena.hpp"
 #include "utils.hpp"
 
 #include <libassert/assert.hpp>
 
 namespace libassert::detail {
-    using path_components = std::vector<std::string>;
+    // Containers here use arena_allocator. The path handler of an assertion_info built in a failure arena is given
+    // that arena, the many small strings and nodes disambiguation builds then come out of it.
+    using path_components = arena_vector<arena_string>;
 
     LIBASSERT_ATTR_COLD
-    path_components parse_path(const std::string_view path);
+    path_components parse_path(const std::string_view path, const arena_allocator<char>& allocator = {});
 
     class path_trie {
         // Backwards path trie structure
@@ -27,18 +27,22 @@ namespace libassert::detail {
         //       \ f - b - a
         // Nodes are marked with the number of downstream branches
         size_t downstream_branches = 1;
-        std::string root;
-        std::unordered_map<std::string, std::unique_ptr<path_trie>> edges;
+        arena_string root;
+        arena_vector<path_trie> edges; // few enough that a linear search is fine
     public:
         LIBASSERT_ATTR_COLD
-        explicit path_trie(std::string _root) : root(std::move(_root)) {};
+        path_trie(std::string_view _root, const arena_allocator<char>& allocator)
+            : root(_root, allocator), edges(allocator) {};
         LIBASSERT_ATTR_COLD
         void insert(const path_components& path);
+        // the result refers to the trie's strings
         LIBASSERT_ATTR_COLD
-        path_components disambiguate(const path_components& path);
+        arena_vector<std::string_view> disambiguate(const path_components& path);
     private:
         LIBASSERT_ATTR_COLD
         void insert(const path_components& path, int i);
+        LIBASSERT_ATTR_COLD
+        path_trie* find_edge(std::string_view component);
     };
 
     class identity_path_handler : public path_handler {
@@ -48,9 +52,14 @@ namespace libassert::detail {
     };
 
     class disambiguating_path_handler : public path_handler {
-        std::vector<std::string> paths;
-        std::unordered_map<std::string, std::string> path_map;
+        arena_allocator<char> allocator;
+        arena_vector<arena_string> paths;
+        arena_string_map<arena_string> path_map;
     public:
+        explicit disambiguating_path_handler(monotonic_arena* arena = nullptr);
+        // copies use the global allocator
+        disambiguating_path_handler(const disambiguating_path_handler&);
+        disambiguating_path_handler& operator=(const disambiguating_path_handler&) = delete;
         std::unique_ptr<detail::path_handler> clone() const override;
         std::string_view resolve_path(std::string_view) override;
         bool has_add_path() const override;
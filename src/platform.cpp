@@ -1,7 +1,9 @@
 #include "platform.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <mutex>
@@ -197,4 +199,22 @@ namespace libassert::detail {
         std::unique_lock lock(strerror_mutex);
         return strerror(e);
     }
+
+    LIBASSERT_ATTR_COLD void write_fully(int fd, const char* data, std::size_t size) {
+        while(size > 0) {
+            #if IS_WINDOWS
+             const int written = _write(fd, data, static_cast<unsigned>(std::min<std::size_t>(size, 1 << 30)));
+            #else
+             const auto written = ::write(fd, data, size);
+            #endif
+            if(written < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
 }
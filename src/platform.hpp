@@ -20,4 +20,9 @@
 
 #include <libassert/assert.hpp>
 
+namespace libassert::detail {
+    // writes everything, retrying on partial writes and EINTR, errors are ignored as there's nowhere to report them
+    LIBASSERT_ATTR_COLD void write_fully(int fd, const char* data, std::size_t size);
+}
+
 #endif
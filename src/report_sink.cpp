@@ -0,0 +1,66 @@
+#include "platform.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include "common.hpp"
+
+#include <libassert/assert.hpp>
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD fd_sink::fd_sink(int fd_) : fd(fd_) {}
+
+    LIBASSERT_ATTR_COLD fd_sink::~fd_sink() {
+        flush();
+    }
+
+    LIBASSERT_ATTR_COLD void fd_sink::write(std::string_view str) {
+        if(str.empty()) {
+            return;
+        }
+        if(used + str.size() > sizeof(buffer)) {
+            flush();
+            // too big to be worth buffering
+            if(str.size() > sizeof(buffer)) {
+                detail::write_fully(fd, str.data(), str.size());
+                return;
+            }
+        }
+        std::memcpy(buffer + used, str.data(), str.size());
+        used += str.size();
+    }
+
+    LIBASSERT_ATTR_COLD void fd_sink::flush() {
+        detail::write_fully(fd, buffer, used);
+        used = 0;
+    }
+
+    LIBASSERT_ATTR_COLD buffer_sink::buffer_sink(char* data_, std::size_t capacity_) : data(data_), capacity(capacity_) {}
+
+    LIBASSERT_ATTR_COLD void buffer_sink::write(std::string_view str) {
+        if(str.empty()) {
+            return;
+        }
+        const std::size_t count = std::min(str.size(), capacity - used);
+        std::memcpy(data + used, str.data(), count);
+        used += count;
+        overflowed = overflowed || count < str.size();
+    }
+
+    LIBASSERT_ATTR_COLD std::string_view buffer_sink::view() const {
+        return {data, used};
+    }
+
+    LIBASSERT_ATTR_COLD bool buffer_sink::truncated() const {
+        return overflowed;
+    }
+
+    LIBASSERT_ATTR_COLD callback_sink::callback_sink(void (*callback_)(void* context, std::string_view), void* context_)
+        : callback(callback_), context(context_) {}
+
+    LIBASSERT_ATTR_COLD void callback_sink::write(std::string_view str) {
+        callback(context, str);
+    }
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <string>
+#include <vector>
+
+#include <libassert/assert.hpp>
+
+#include "common.hpp"
+#include "utils.hpp"
+
+namespace libassert::detail {
+    namespace {
+        struct sampling_override {
+            std::string file;
+            std::uint32_t line;
+            double rate;
+        };
+
+        // Only touched when a site is first reached, when it's torn down, or when rates are changed. Never on the
+        // sampling path.
+        struct sampling_registry {
+            std::mutex mutex;
+            std::vector<sampling_site*> sites;
+            std::vector<sampling_override> overrides;
+        };
+
+        sampling_registry& get_sampling_registry() {
+            static sampling_registry registry;
+            return registry;
+        }
+
+        std::uint32_t sampling_value(sampling_site::kind site_kind, double rate_or_period) {
+            constexpr auto max = std::numeric_limits<std::uint32_t>::max();
+            if(site_kind == sampling_site::kind::every_n) {
+                if(!(rate_or_period >= 1)) { // also catches nan
+                    return 1;
+                }
+                return rate_or_period >= max ? max : static_cast<std::uint32_t>(rate_or_period);
+            } else {
+                if(!(rate_or_period > 0)) {
+                    return 0;
+                }
+                if(rate_or_period >= 1) {
+                    return max;
+                }
+                return static_cast<std::uint32_t>(rate_or_period * 4294967296.0);
+            }
+        }
+
+        // rates given to set_sampling_rate are probabilities, every_n sites want a period
+        double rate_to_site_value(sampling_site::kind site_kind, double rate) {
+            if(site_kind == sampling_site::kind::every_n) {
+                return rate > 0 ? std::round(1 / rate) : static_cast<double>(std::numeric_limits<std::uint32_t>::max());
+            }
+            return rate;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD
+    sampling_site::sampling_site(kind site_kind_, double rate_or_period, std::string_view file_, std::uint32_t line_)
+        : site_kind(site_kind_), value(sampling_value(site_kind_, rate_or_period)), file(file_), line(line_) {
+        auto& registry = get_sampling_registry();
+        const std::unique_lock lock(registry.mutex);
+        for(const auto& entry : registry.overrides) {
+            if(matches(entry.file, entry.line)) {
+                set_rate(entry.rate);
+            }
+        }
+        registry.sites.push_back(this);
+    }
+
+    LIBASSERT_ATTR_COLD
+    sampling_site::~sampling_site() {
+        auto& registry = get_sampling_registry();
+        const std::unique_lock lock(registry.mutex);
+        registry.sites.erase(std::remove(registry.sites.begin(), registry.sites.end(), this), registry.sites.end());
+    }
+
+    LIBASSERT_ATTR_COLD
+    bool sampling_site::matches(std::string_view file_, std::uint32_t line_) const {
+        if(
+            line_ != line
+            || file_.empty()
+            || file_.size() > file.size()
+            || file.substr(file.size() - file_.size()) != file_
+        ) {
+            return false;
+        }
+        // only match whole path components
+        return file_.size() == file.size()
+            || needle(file[file.size() - file_.size() - 1]).is_in('/', '\\')
+            || needle(file_.front()).is_in('/', '\\');
+    }
+
+    LIBASSERT_ATTR_COLD
+    void sampling_site::set_rate(double rate) {
+        value.store(sampling_value(site_kind, rate_to_site_value(site_kind, rate)), std::memory_order_relaxed);
+    }
+}
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    std::size_t set_sampling_rate(std::string_view file, std::uint32_t line, double rate) {
+        auto& registry = detail::get_sampling_registry();
+        const std::unique_lock lock(registry.mutex);
+        auto it = std::find_if(
+            registry.overrides.begin(),
+            registry.overrides.end(),
+            [&](const detail::sampling_override& entry) { return entry.file == file && entry.line == line; }
+        );
+        if(it == registry.overrides.end()) {
+            registry.overrides.push_back({std::string(file), line, rate});
+        } else {
+            it->rate = rate;
+        }
+        std::size_t updated = 0;
+        for(auto* site : registry.sites) {
+            if(site->matches(file, line)) {
+                site->set_rate(rate);
+                updated++;
+            }
+        }
+        return updated;
+    }
+}
@@ -0,0 +1,175 @@
+#include "site_cache.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <string>
+#include <utility>
+
+#include "analysis.hpp"
+#include "utils.hpp"
+
+namespace libassert::detail {
+    namespace {
+        // ansi_basic, ansi_rgb, blank
+        constexpr std::size_t n_builtin_schemes = 3;
+
+        std::optional<std::size_t> builtin_scheme_index(const color_scheme& scheme) {
+            if(scheme == color_scheme::ansi_basic) {
+                return 0;
+            } else if(scheme == color_scheme::ansi_rgb) {
+                return 1;
+            } else if(scheme == color_scheme::blank) {
+                return 2;
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        // Values are published once with a CAS and are never modified or freed afterwards, that way readers never need
+        // a lock and never observe a value being torn down. Everything here is bounded by the table size.
+        std::atomic<std::size_t> fills = 0;
+
+        template<typename T, typename F>
+        const T& memoize(std::atomic<const T*>& slot, F&& f) {
+            const T* value = slot.load(std::memory_order_acquire);
+            if(value == nullptr) {
+                fills.fetch_add(1, std::memory_order_relaxed);
+                // new rather than make_unique so f's result is constructed in place, T needn't be movable
+                std::unique_ptr<const T> fresh(new T(f()));
+                if(slot.compare_exchange_strong(value, fresh.get(), std::memory_order_acq_rel)) {
+                    value = fresh.release();
+                }
+                // otherwise another thread won, value now holds its result
+            }
+            return *value;
+        }
+
+        struct cached_text {
+            std::string source;
+            std::string text; // the source after any preprocessing, i.e. prettify_type
+            mutable std::array<std::atomic<const std::string*>, n_builtin_schemes> highlighted;
+            cached_text(std::string_view source_, std::string text_) : source(source_), text(std::move(text_)) {
+                for(auto& slot : highlighted) {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct cached_decomposition {
+            // a slot's key can be reused by a different site, e.g. after a library is unloaded and another loaded
+            std::string expression;
+            std::string op;
+            std::pair<std::string, std::string> result;
+        };
+
+        struct site_cache_entry {
+            const assert_static_parameters* key;
+            std::atomic<const cached_decomposition*> decomposition;
+            std::array<std::atomic<const cached_text*>, 3> texts; // indexed by site_text
+            explicit site_cache_entry(const assert_static_parameters* key_) : key(key_), decomposition(nullptr) {
+                for(auto& slot : texts) {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // open addressing, linear probing, zero-initialized
+        std::array<std::atomic<site_cache_entry*>, site_cache_size> site_cache_table;
+
+        site_cache_entry* get_entry(const assert_static_parameters* params) {
+            if(params == nullptr) {
+                return nullptr;
+            }
+            // params are at least pointer-aligned, drop the low bits before mixing
+            const auto hash = static_cast<std::size_t>(
+                (reinterpret_cast<std::uintptr_t>(params) >> 3) * 0x9E3779B97F4A7C15ULL // NOLINT
+            );
+            for(std::size_t probe = 0; probe < site_cache_size; probe++) {
+                auto& slot = site_cache_table[(hash + probe) % site_cache_size];
+                site_cache_entry* entry = slot.load(std::memory_order_acquire);
+                if(entry == nullptr) {
+                    auto fresh = std::make_unique<site_cache_entry>(params);
+                    if(slot.compare_exchange_strong(entry, fresh.get(), std::memory_order_acq_rel)) {
+                        return fresh.release();
+                    }
+                    // lost the race, entry is now whatever was inserted
+                }
+                if(entry->key == params) {
+                    return entry;
+                }
+            }
+            return nullptr;
+        }
+
+        // nullptr if the site isn't cached or the cached source doesn't match, e.g. if a handler changed the info
+        const cached_text* get_text(const assert_static_parameters* params, site_text which, std::string_view source) {
+            site_cache_entry* entry = get_entry(params);
+            if(entry == nullptr) {
+                return nullptr;
+            }
+            const auto& text = memoize(entry->texts[static_cast<std::size_t>(which)], [&] {
+                return cached_text(
+                    source,
+                    which == site_text::function ? prettify_type(std::string(source)) : std::string(source)
+                );
+            });
+            return text.source == source ? &text : nullptr;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD
+    std::string prettify_function(const assert_static_parameters* params, std::string_view signature) {
+        if(const auto* text = get_text(params, site_text::function, signature)) {
+            return text->text;
+        }
+        return prettify_type(std::string(signature));
+    }
+
+    LIBASSERT_ATTR_COLD
+    std::string highlight_site_text(
+        const assert_static_parameters* params,
+        site_text which,
+        std::string_view source,
+        const color_scheme& scheme
+    ) {
+        const auto scheme_index = builtin_scheme_index(scheme);
+        if(scheme_index) {
+            if(const auto* text = get_text(params, which, source)) {
+                return memoize(text->highlighted[*scheme_index], [&] { return detail::highlight(text->text, scheme); });
+            }
+        }
+        if(which == site_text::function) {
+            return detail::highlight(prettify_type(std::string(source)), scheme);
+        }
+        return detail::highlight(source, scheme);
+    }
+
+    LIBASSERT_ATTR_COLD
+    std::pair<std::string, std::string> decompose_expression(
+        const assert_static_parameters* params,
+        std::string_view target_op
+    ) {
+        // the target op is fixed for a call site, it's determined by the type of the decomposer
+        if(site_cache_entry* entry = get_entry(params)) {
+            const auto& cached = memoize(entry->decomposition, [&] {
+                return cached_decomposition{
+                    std::string(params->expr_str),
+                    std::string(target_op),
+                    decompose_expression(params->expr_str, target_op)
+                };
+            });
+            if(cached.expression == params->expr_str && cached.op == target_op) {
+                return cached.result;
+            }
+        }
+        return decompose_expression(params->expr_str, target_op);
+    }
+
+    std::size_t site_cache_fills() {
+        return fills.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef SITE_CACHE_HPP
+#define SITE_CACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <libassert/assert.hpp>
+
+#include "common.hpp"
+
+namespace libassert::detail {
+    // Per-call-site memoization of the parts of a failure message which only depend on the call site. Sites are
+    // identified by the address of their static parameters. Reads are lock-free, the table has a fixed number of slots
+    // and once it's full new sites are just not cached.
+    constexpr std::size_t site_cache_size = 1024;
+
+    enum class site_text {
+        statement,
+        statement_with_args,
+        function
+    };
+
+    // Equivalent to prettify_type(signature) but memoized for the call site
+    LIBASSERT_ATTR_COLD
+    std::string prettify_function(const assert_static_parameters* params, std::string_view signature);
+
+    // Equivalent to highlight(source, scheme), or highlight(prettify_type(source), scheme) for site_text::function, but
+    // memoized for the call site. Only highlighting with the built-in color schemes is cached.
+    LIBASSERT_ATTR_COLD
+    std::string highlight_site_text(
+        const assert_static_parameters* params,
+        site_text which,
+        std::string_view source,
+        const color_scheme& scheme
+    );
+
+    // How many values have been computed and stored in the cache, for testing
+    LIBASSERT_EXPORT_TESTING std::size_t site_cache_fills();
+}
+
+#endif
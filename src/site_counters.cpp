@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <libassert/assert.hpp>
+
+#include "common.hpp"
+#include "microfmt.hpp"
+
+namespace libassert::detail {
+    namespace {
+        // Only touched when a site is first reached, when it's torn down, or when the counts are read. Never on the
+        // counting path.
+        struct site_counter_registry {
+            std::mutex mutex;
+            std::vector<site_counter*> sites;
+        };
+
+        site_counter_registry& get_site_counter_registry() {
+            static site_counter_registry registry;
+            return registry;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD
+    site_counter::site_counter(const assert_static_parameters* params_) : params(params_), evaluations(0), failures(0) {
+        auto& registry = get_site_counter_registry();
+        const std::unique_lock lock(registry.mutex);
+        registry.sites.push_back(this);
+    }
+
+    LIBASSERT_ATTR_COLD
+    site_counter::~site_counter() {
+        auto& registry = get_site_counter_registry();
+        const std::unique_lock lock(registry.mutex);
+        registry.sites.erase(std::remove(registry.sites.begin(), registry.sites.end(), this), registry.sites.end());
+    }
+}
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    std::vector<site_counts> get_site_counts() {
+        std::vector<site_counts> counts;
+        {
+            auto& registry = detail::get_site_counter_registry();
+            const std::unique_lock lock(registry.mutex);
+            counts.reserve(registry.sites.size());
+            for(const auto* site : registry.sites) {
+                counts.push_back({
+                    site->params->macro_name,
+                    site->params->expr_str,
+                    site->params->location.file,
+                    static_cast<std::uint32_t>(site->params->location.line),
+                    site->evaluations.load(std::memory_order_relaxed),
+                    site->failures.load(std::memory_order_relaxed)
+                });
+            }
+        }
+        // each instantiation of a template has its own counter for the same site, those are combined here
+        const auto site_key = [](const site_counts& site) {
+            return std::tie(site.file, site.line, site.macro_name, site.expression);
+        };
+        std::sort(counts.begin(), counts.end(), [&](const site_counts& a, const site_counts& b) {
+            return site_key(a) < site_key(b);
+        });
+        std::vector<site_counts> merged;
+        for(const auto& site : counts) {
+            if(!merged.empty() && site_key(merged.back()) == site_key(site)) {
+                merged.back().evaluations += site.evaluations;
+                merged.back().failures += site.failures;
+            } else {
+                merged.push_back(site);
+            }
+        }
+        std::stable_sort(merged.begin(), merged.end(), [](const site_counts& a, const site_counts& b) {
+            return a.evaluations > b.evaluations;
+        });
+        return merged;
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void reset_site_counts() {
+        auto& registry = detail::get_site_counter_registry();
+        const std::unique_lock lock(registry.mutex);
+        for(auto* site : registry.sites) {
+            site->evaluations.store(0, std::memory_order_relaxed);
+            site->failures.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void write_site_counts(report_sink& sink) {
+        sink.write(microfmt::format("{>20} {>20}  {}\n", "evaluations", "failures", "site"));
+        for(const auto& site : get_site_counts()) {
+            sink.write(
+                microfmt::format(
+                    "{>20} {>20}  {}:{} {}({})\n",
+                    site.evaluations,
+                    site.failures,
+                    site.file,
+                    site.line,
+                    site.macro_name,
+                    site.expression
+                )
+            );
+        }
+        sink.flush();
+    }
+}
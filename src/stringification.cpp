@@ -1,11 +1,16 @@
-#include <bitset>
-#include <iomanip>
+// provides LIBASSERT_PRECOMPILED_STRINGIFICATIONS for the explicit instantiations at the end of this file
+#define LIBASSERT_INSTANTIATE_PRECOMPILED_STRINGIFICATION
+
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <mutex>
 #include <sstream>
 #include <string>
 
 #include "analysis.hpp"
+#include "escape.hpp"
+#include "number_format.hpp"
 #include "utils.hpp"
 
 #include <libassert/assert.hpp>
@@ -103,32 +108,166 @@ namespace libassert::detail {
     }
 
     /*
-     * Stringification
+     * Output budget
      */
 
+    // 0 = unlimited
+    std::atomic<std::size_t> value_stringification_budget{64 * 1024};
+    std::atomic<std::size_t> assertion_stringification_budget{256 * 1024};
+
+    // Everything stringified on the thread is charged to a running total, scopes set the total at which output starts
+    // being elided
+    thread_local std::size_t budget_used = 0;
+    thread_local std::size_t budget_limit = std::numeric_limits<std::size_t>::max();
+
+    LIBASSERT_EXPORT std::size_t stringification_budget_remaining() {
+        return budget_limit > budget_used ? budget_limit - budget_used : 0;
+    }
+
+    LIBASSERT_EXPORT void charge_stringification_budget(std::size_t bytes) {
+        budget_used += bytes;
+    }
+
+    LIBASSERT_EXPORT std::string fit_stringification_budget(std::string str) {
+        if(str.size() > stringification_budget_remaining()) {
+            budget_used = budget_limit;
+            return std::string(elision_marker);
+        }
+        budget_used += str.size();
+        return str;
+    }
+
+    LIBASSERT_EXPORT bool fit_stringification_budget(std::string& out, std::size_t start) {
+        if(out.size() - start > stringification_budget_remaining()) {
+            budget_used = budget_limit;
+            out.resize(start);
+            out += elision_marker;
+            return true;
+        }
+        budget_used += out.size() - start;
+        return false;
+    }
+
+    LIBASSERT_EXPORT stringification_budget_scope::stringification_budget_scope(kind which)
+        : previous_limit(budget_limit) {
+        const std::size_t budget = which == value
+            ? value_stringification_budget.load(std::memory_order_relaxed)
+            : assertion_stringification_budget.load(std::memory_order_relaxed);
+        if(budget != 0) {
+            budget_limit = std::min(budget_limit, budget_used + budget);
+        }
+    }
+
+    LIBASSERT_EXPORT stringification_budget_scope::~stringification_budget_scope() {
+        budget_limit = previous_limit;
+    }
+}
+
+namespace libassert::detail {
+    constexpr std::size_t max_kept_buffer_size = 1 << 16;
+
     LIBASSERT_ATTR_COLD
-    static std::string escape_string(const std::string_view str, char quote) {
-        std::string escaped;
-        escaped += quote;
-        for(const char c : str) {
-            if(c == '\\') escaped += "\\\\";
-            else if(c == '\t') escaped += "\\t";
-            else if(c == '\r') escaped += "\\r";
-            else if(c == '\n') escaped += "\\n";
-            else if(c == quote) escaped += std::initializer_list<char>{'\\', quote};
-            else if(c >= 32 && c <= 126) escaped += c; // printable
-            else {
-                constexpr const char * const hexdig = "0123456789abcdef";
-                escaped += std::string("\\x") + hexdig[c >> 4] + hexdig[c & 0xF];
+    static void generate_stringification_into(
+        std::string& out,
+        const void* value,
+        bool(*stringify_into)(std::string&, const void*),
+        std::string_view type_prefix,
+        std::size_t size_estimate
+    ) {
+        const stringification_budget_scope budget_scope(stringification_budget_scope::value);
+        if(!type_prefix.empty()) {
+            out += prettify_type(std::string(type_prefix));
+            out += ": ";
+        }
+        if(size_estimate != 0) {
+            out.reserve(out.size() + std::min(size_estimate, stringification_budget_remaining()));
+        }
+        stringify_into(out, value);
+    }
+
+    LIBASSERT_EXPORT std::string generate_stringification_erased(
+        const void* value,
+        bool(*stringify_into)(std::string&, const void*),
+        std::string_view type_prefix,
+        std::size_t size_estimate
+    ) {
+        std::string str;
+        generate_stringification_into(str, value, stringify_into, type_prefix, size_estimate);
+        return str;
+    }
+
+    LIBASSERT_EXPORT arena_string generate_stringification_erased(
+        const void* value,
+        bool(*stringify_into)(std::string&, const void*),
+        std::string_view type_prefix,
+        std::size_t size_estimate,
+        const arena_allocator<char>& allocator
+    ) {
+        // stringifying a value can fail an assertion and end up back here
+        thread_local std::string buffer;
+        thread_local bool buffer_in_use = false;
+        if(buffer_in_use) {
+            return arena_string(
+                generate_stringification_erased(value, stringify_into, type_prefix, size_estimate),
+                allocator
+            );
+        }
+        buffer_in_use = true;
+        struct release {
+            ~release() {
+                buffer_in_use = false;
+                // don't hold on to an unusually large value's buffer
+                if(buffer.capacity() > max_kept_buffer_size) {
+                    std::string().swap(buffer);
+                }
             }
+        } releaser;
+        buffer.clear();
+        generate_stringification_into(buffer, value, stringify_into, type_prefix, size_estimate);
+        return arena_string(buffer, allocator);
+    }
+}
+
+namespace libassert {
+    LIBASSERT_EXPORT void set_stringification_budget(std::size_t value_bytes, std::size_t assertion_bytes) {
+        detail::value_stringification_budget = value_bytes;
+        detail::assertion_stringification_budget = assertion_bytes;
+    }
+}
+
+namespace libassert::detail {
+    /*
+     * Stringification
+     */
+
+    LIBASSERT_ATTR_COLD
+    static void escape_string_into(std::string& out, const std::string_view str, char quote) {
+        static const escape_scanner scan = select_escape_scanner();
+        // strings that don't fit in the output budget are cut off, leaving room for the closing quote and the marker
+        const std::size_t remaining = stringification_budget_remaining();
+        const std::size_t room = remaining > elision_marker.size() + 1 ? remaining - elision_marker.size() - 1 : 1;
+        const std::size_t max_size = room > std::string::npos - out.size() ? std::string::npos : out.size() + room;
+        if(out.empty()) {
+            // nested strings rely on the buffer's geometric growth, an exact reserve would defeat it
+            out.reserve(std::min(str.size(), room) + 2);
+        }
+        out += quote;
+        const bool complete = append_escaped(out, str, quote, scan, max_size);
+        out += quote;
+        if(!complete) {
+            out += elision_marker;
         }
-        escaped += quote;
-        return escaped;
     }
 
     namespace stringification {
         LIBASSERT_ATTR_COLD std::string stringify(std::string_view value) {
-            return escape_string(value, '"');
+            std::string str;
+            escape_string_into(str, value, '"');
+            return str;
+        }
+
+        LIBASSERT_ATTR_COLD void stringify_into(std::string& out, std::string_view value) {
+            escape_string_into(out, value, '"');
         }
 
         LIBASSERT_ATTR_COLD std::string stringify(std::nullptr_t) {
@@ -139,7 +278,9 @@ namespace libassert::detail {
             if(get_thread_current_literal_format() & literal_format::integer_character) {
                 return stringify(static_cast<int>(value));
             } else {
-                return escape_string({&value, 1}, '\'');
+                std::string str;
+                escape_string_into(str, {&value, 1}, '\'');
+                return str;
             }
         }
 
@@ -148,9 +289,8 @@ namespace libassert::detail {
         }
 
         template<typename T, typename std::enable_if<is_integral_and_not_bool<T>, int>::type = 0>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        static std::string stringify_integral(T value, literal_format format) {
-            std::ostringstream oss;
+        LIBASSERT_ATTR_COLD
+        static void append_integral(std::string& out, T value, literal_format format) {
             switch(format) {
                 case literal_format::integer_character:
                     if(
@@ -158,38 +298,39 @@ namespace libassert::detail {
                         cmp_less_equal(value, std::numeric_limits<char>::max())
                     ) {
                         char c = static_cast<char>(value);
-                        return escape_string({&c, 1}, '\'');
+                        escape_string_into(out, {&c, 1}, '\'');
                     } else {
                         // TODO: Handle this better
-                        return "<no char>";
+                        out += "<no char>";
                     }
                     break;
                 case literal_format::integer_hex:
-                    oss<<std::showbase<<std::hex;
+                    append_hex(out, value);
                     break;
                 case literal_format::integer_octal:
-                    oss<<std::showbase<<std::oct;
+                    append_octal(out, value);
                     break;
                 case literal_format::integer_binary:
-                    oss<<"0b"<<std::bitset<sizeof(value) * 8>(value);
-                    goto r;
+                    append_binary(out, value);
+                    break;
                 case literal_format::default_format:
+                    append_decimal(out, value);
                     break;
                 default:
                     LIBASSERT_PRIMITIVE_DEBUG_ASSERT(false, "unexpected literal format requested for printing");
             }
-            oss<<value;
-            r: return std::move(oss).str();
         }
 
         template<typename T, typename std::enable_if<is_integral_and_not_bool<T>, int>::type = 0>
         LIBASSERT_ATTR_COLD [[nodiscard]]
         static std::string stringify_integral(T value) {
             auto current_format = get_thread_current_literal_format();
-            std::string result = stringify_integral(value, literal_format::default_format);
+            std::string result;
             if(current_format & literal_format::integer_character) {
-                result = stringify_integral(value, literal_format::integer_character) + ' ' + std::move(result);
+                append_integral(result, value, literal_format::integer_character);
+                result += ' ';
             }
+            append_integral(result, value, literal_format::default_format);
             if(current_format & non_default_integer_formats) {
                 for(auto format : {
                     literal_format::integer_hex,
@@ -198,7 +339,7 @@ namespace libassert::detail {
                 }) {
                     if(current_format & format) {
                         result += ' ';
-                        result += stringify_integral(value, format);
+                        append_integral(result, value, format);
                     }
                 }
             }
@@ -237,37 +378,15 @@ namespace libassert::detail {
             return stringify_integral(value);
         }
 
-        template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
-        LIBASSERT_ATTR_COLD [[nodiscard]]
-        static std::string stringify_floating_point(T value, literal_format format) {
-            std::ostringstream oss;
-            if(format == literal_format::float_hex) {
-                // apparently std::hexfloat automatically prepends "0x" while std::hex does not
-                oss<<std::hexfloat;
-            }
-            oss<<std::setprecision(std::numeric_limits<T>::max_digits10)<<value;
-            std::string s = std::move(oss).str();
-            // std::showpoint adds a bunch of unecessary digits, so manually doing it correctly here
-            if(s.find('.') == std::string::npos) {
-                s += ".0";
-            }
-            return s;
-        }
-
         template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
         LIBASSERT_ATTR_COLD [[nodiscard]]
         static std::string stringify_floating_point(T value) {
             auto current_format = get_thread_current_literal_format();
-            std::string result = stringify_floating_point(value, literal_format::default_format);
-            if(current_format & non_default_float_formats) {
-                for(auto format : { literal_format::float_hex }) {
-                    if(current_format & format) {
-                        if(!result.empty()) {
-                            result += ' ';
-                        }
-                        result += stringify_floating_point(value, format);
-                    }
-                }
+            std::string result;
+            append_floating_point(result, value, false);
+            if(current_format & literal_format::float_hex) {
+                result += ' ';
+                append_floating_point(result, value, true);
             }
             return result;
         }
@@ -346,3 +465,17 @@ namespace libassert::detail {
         }
     }
 }
+
+namespace libassert::detail {
+    #define LIBASSERT_INSTANTIATE_STRINGIFICATION(...) \
+        template LIBASSERT_EXPORT bool do_stringify_into<__VA_ARGS__>(std::string&, __VA_ARGS__ const&); \
+        template LIBASSERT_EXPORT std::string do_stringify<__VA_ARGS__>(__VA_ARGS__ const&); \
+        template LIBASSERT_EXPORT std::string generate_stringification<__VA_ARGS__>(__VA_ARGS__ const&); \
+        template LIBASSERT_EXPORT arena_string generate_stringification<__VA_ARGS__>( \
+            __VA_ARGS__ const&, \
+            const arena_allocator<char>& \
+        );
+
+    LIBASSERT_PRECOMPILED_STRINGIFICATIONS(LIBASSERT_INSTANTIATE_STRINGIFICATION)
+    #undef LIBASSERT_INSTANTIATE_STRINGIFICATION
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+
+#if defined(__has_include) && __has_include(<cpptrace/basic.hpp>)
+ #include <cpptrace/basic.hpp>
+#else
+ #include <cpptrace/cpptrace.hpp>
+#endif
+
+#include <libassert/assert.hpp>
+
+#include "common.hpp"
+#include "microfmt.hpp"
+
+namespace libassert::detail {
+    namespace {
+        std::atomic<std::size_t> max_reports_per_site = 0; // 0 = disabled
+        std::atomic<bool> suppress_per_stack_trace = false;
+        std::atomic<std::uint64_t> summary_interval_ms = 10000;
+
+        struct site_counters {
+            std::atomic<std::uint64_t> key; // 0 = empty
+            std::atomic<const assert_static_parameters*> params; // for the summary
+            std::atomic<std::uint64_t> failures;
+            std::atomic<std::uint64_t> suppressed;
+            std::atomic<std::uint64_t> summarized; // suppressed at the time of the last summary
+            std::atomic<std::int64_t> last_summary_ms;
+        };
+
+        // Fixed size open-addressed table, entries are claimed with a CAS on the key and only released by
+        // reset_failure_suppression. Sites that don't fit aren't counted and are always reported, sharing an entry
+        // could suppress a site that never failed.
+        constexpr std::size_t suppression_table_size = 4096;
+        constexpr std::size_t max_probe = 64;
+        std::array<site_counters, suppression_table_size> suppression_table;
+
+        // frames hashed with per_stack_trace, captured into a buffer on the stack
+        constexpr std::size_t max_key_frames = 64;
+
+        std::uint64_t mix(std::uint64_t hash, std::uint64_t value) {
+            // boost::hash_combine style mixing, good enough for bucketing pointers and frame addresses
+            hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+
+        std::uint64_t site_key(const assert_static_parameters* params) {
+            // params are at least pointer-aligned, drop the low bits before mixing
+            std::uint64_t key = mix(0, reinterpret_cast<std::uintptr_t>(params) >> 3);
+            if(suppress_per_stack_trace.load(std::memory_order_relaxed)) {
+                cpptrace::frame_ptr frames[max_key_frames]; // NOLINT(*-avoid-c-arrays)
+                const std::size_t count = cpptrace::safe_generate_raw_trace(frames, max_key_frames);
+                if(count > 0) {
+                    for(std::size_t i = 0; i < count; i++) {
+                        key = mix(key, static_cast<std::uint64_t>(frames[i]));
+                    }
+                } else {
+                    // not supported on this platform
+                    for(const auto frame : cpptrace::generate_raw_trace().frames) {
+                        key = mix(key, static_cast<std::uint64_t>(frame));
+                    }
+                }
+            }
+            return key == 0 ? 1 : key;
+        }
+
+        site_counters* get_counters(std::uint64_t key) {
+            for(std::size_t probe = 0; probe < max_probe; probe++) {
+                auto& entry = suppression_table[(key + probe) % suppression_table_size];
+                std::uint64_t current = entry.key.load(std::memory_order_acquire);
+                if(current == 0 && entry.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    return &entry;
+                }
+                if(current == key) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        std::int64_t now_ms() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+        }
+
+        // only assertions, debug assertions, and assumptions are suppressed
+        std::string_view suppressed_action(assert_type type) {
+            switch(type) {
+                case assert_type::debug_assertion: return "Debug Assertion failed";
+                case assert_type::assumption:      return "Assumption failed";
+                default:
+                    return "Assertion failed";
+            }
+        }
+
+        // writes how many failures were suppressed since the last summary of the entry, if any
+        void write_summary(site_counters& counters) {
+            const auto* params = counters.params.load(std::memory_order_acquire);
+            const std::uint64_t suppressed = counters.suppressed.load(std::memory_order_relaxed);
+            const std::uint64_t previous = counters.summarized.exchange(suppressed, std::memory_order_relaxed);
+            if(params == nullptr || suppressed <= previous) {
+                return;
+            }
+            std::cerr << microfmt::format(
+                "{} at {}:{}: {} more failures suppressed ({} total)\n",
+                suppressed_action(params->type),
+                params->location.file,
+                params->location.line,
+                suppressed - previous,
+                counters.failures.load(std::memory_order_relaxed)
+            ) << std::flush;
+        }
+
+        // failures suppressed since the last summary would otherwise go unmentioned
+        void write_pending_summaries() {
+            for(auto& counters : suppression_table) {
+                if(counters.key.load(std::memory_order_acquire) != 0) {
+                    write_summary(counters);
+                }
+            }
+        }
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    bool should_suppress(const assert_static_parameters* params) {
+        const std::size_t max_reports = max_reports_per_site.load(std::memory_order_relaxed);
+        // handlers must not return for panics and unreachables
+        if(max_reports == 0 || params->type == assert_type::panic || params->type == assert_type::unreachable) {
+            return false;
+        }
+        auto* entry = get_counters(site_key(params));
+        if(entry == nullptr) {
+            return false;
+        }
+        auto& counters = *entry;
+        counters.params.store(params, std::memory_order_release);
+        const std::uint64_t failures = counters.failures.fetch_add(1, std::memory_order_relaxed) + 1;
+        if(failures <= max_reports) {
+            return false;
+        }
+        counters.suppressed.fetch_add(1, std::memory_order_relaxed);
+        static std::once_flag at_exit;
+        std::call_once(at_exit, [] { std::atexit(write_pending_summaries); });
+        // one thread per interval gets to write the summary
+        const std::int64_t now = now_ms();
+        std::int64_t last = counters.last_summary_ms.load(std::memory_order_relaxed);
+        const auto interval = static_cast<std::int64_t>(summary_interval_ms.load(std::memory_order_relaxed));
+        if(
+            (last == 0 || now - last >= interval)
+            && counters.last_summary_ms.compare_exchange_strong(last, now, std::memory_order_relaxed)
+        ) {
+            write_summary(counters);
+        }
+        return true;
+    }
+}
+
+namespace libassert {
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void set_failure_suppression(std::size_t max_reports, bool per_stack_trace, std::uint64_t summary_interval) {
+        detail::suppress_per_stack_trace = per_stack_trace;
+        detail::summary_interval_ms = summary_interval;
+        detail::max_reports_per_site = max_reports;
+    }
+
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT
+    void reset_failure_suppression() {
+        for(auto& counters : detail::suppression_table) {
+            counters.params.store(nullptr, std::memory_order_relaxed);
+            counters.failures.store(0, std::memory_order_relaxed);
+            counters.suppressed.store(0, std::memory_order_relaxed);
+            counters.summarized.store(0, std::memory_order_relaxed);
+            counters.last_summary_ms.store(0, std::memory_order_relaxed);
+            counters.key.store(0, std::memory_order_release);
+        }
+    }
+}
@@ -570,4 +570,228 @@ namespace libassert::detail {
             return std::nullopt;
         }
     }
+
+    // Hand-written recognizers for the literal grammar, each one matches the entire input or fails
+    // http://eel.is/c++draft/lex.icon http://eel.is/c++draft/lex.fcon
+    class literal_scanner {
+        std::string_view source;
+        std::size_t i = 0;
+        bool error = false;
+    public:
+        literal_scanner(std::string_view source_) : source(source_) {}
+
+        // 0[Bb][01]('?[01])* integer-suffix?
+        bool binary_integer() {
+            return accept('0') && accept_any("Bb") && digit_sequence(is_binary_digit) && integer_suffix();
+        }
+
+        // 0('?[0-7])+ integer-suffix?
+        // slightly modified from grammar so 0 is lexed as a decimal literal instead of octal
+        bool octal_integer() {
+            if(!accept('0')) {
+                return false;
+            }
+            std::size_t count = 0;
+            while(true) {
+                if(is_octal_digit(peek())) {
+                    i++;
+                } else if(peek() == '\'' && is_octal_digit(peek(1))) {
+                    i += 2;
+                } else {
+                    break;
+                }
+                count++;
+            }
+            return count > 0 && integer_suffix();
+        }
+
+        // (0|[1-9]('?[0-9])*) integer-suffix?
+        bool decimal_integer() {
+            if(accept('0')) {
+                return integer_suffix();
+            }
+            return peek() != '0' && digit_sequence(is_digit) && integer_suffix();
+        }
+
+        // 0[Xx][0-9a-fA-F]('?[0-9a-fA-F])* integer-suffix?
+        bool hex_integer() {
+            return accept('0') && accept_any("Xx") && digit_sequence(is_hex_digit) && integer_suffix();
+        }
+
+        // (fractional-constant exponent-part? | digit-sequence exponent-part) [FfLl]?
+        bool decimal_float() {
+            const bool has_whole = digit_sequence(is_digit);
+            const bool has_point = accept('.');
+            const bool has_fraction = has_point && digit_sequence(is_digit);
+            if(!has_whole && !has_fraction) {
+                return false;
+            }
+            const bool has_exponent = exponent_part("Ee");
+            if(!has_point && !has_exponent) {
+                return false;
+            }
+            accept_any("FfLl");
+            return done();
+        }
+
+        // 0[Xx](hex-fractional-constant | hex-digit-sequence) binary-exponent-part [FfLl]?
+        bool hex_float() {
+            if(!(accept('0') && accept_any("Xx"))) {
+                return false;
+            }
+            const bool has_whole = digit_sequence(is_hex_digit);
+            const bool has_fraction = accept('.') && digit_sequence(is_hex_digit);
+            if(!has_whole && !has_fraction) {
+                return false;
+            }
+            if(!exponent_part("Pp")) {
+                return false;
+            }
+            accept_any("FfLl");
+            return done();
+        }
+
+        // (u8|[UuL])?'(escape-sequence|[^\n'])*'
+        bool char_literal() {
+            if(source.substr(0, 2) == "u8") {
+                i += 2;
+            } else {
+                accept_any("UuL");
+            }
+            if(!accept('\'')) {
+                return false;
+            }
+            while(i < source.size() && peek() != '\'' && peek() != '\n') {
+                const auto escape_length = escape_sequence_length(source, i);
+                i += escape_length ? escape_length : 1;
+            }
+            return accept('\'') && done();
+        }
+    private:
+        static bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        static bool is_binary_digit(char c) {
+            return c == '0' || c == '1';
+        }
+
+        [[nodiscard]] char peek(std::size_t count = 0) const {
+            return i + count < source.size() ? source[i + count] : 0;
+        }
+
+        bool accept(char c) {
+            if(i < source.size() && peek() == c) {
+                i++;
+                return true;
+            }
+            return false;
+        }
+
+        bool accept_any(std::string_view chars) {
+            if(i < source.size() && chars.find(peek()) != std::string_view::npos) {
+                i++;
+                return true;
+            }
+            return false;
+        }
+
+        // digit ('? digit)*
+        template<typename P>
+        bool digit_sequence(const P& is_digit_char) {
+            if(!is_digit_char(peek())) {
+                return false;
+            }
+            i++;
+            while(true) {
+                if(is_digit_char(peek())) {
+                    i++;
+                } else if(peek() == '\'' && is_digit_char(peek(1))) {
+                    i += 2;
+                } else {
+                    return true;
+                }
+            }
+        }
+
+        // [Ee][+-]? digit-sequence
+        // A marker without a valid digit sequence poisons the scan, it can't be anything else
+        bool exponent_part(std::string_view markers) {
+            if(!accept_any(markers)) {
+                return false;
+            }
+            accept_any("+-");
+            if(!digit_sequence(is_digit)) {
+                error = true;
+                return false;
+            }
+            return true;
+        }
+
+        // ([Uu](LL?|ll?|Z|z)? | (LL?|ll?|Z|z)[Uu]?)? followed by the end of the input
+        bool integer_suffix() {
+            const auto size_suffix = [this] {
+                if(source.substr(i, 2) == "LL" || source.substr(i, 2) == "ll") {
+                    i += 2;
+                    return true;
+                }
+                return accept_any("LlZz");
+            };
+            if(accept_any("Uu")) {
+                size_suffix();
+            } else if(size_suffix()) {
+                accept_any("Uu");
+            }
+            return done();
+        }
+
+        [[nodiscard]] bool done() const {
+            return !error && i == source.size();
+        }
+    };
+
+    std::optional<literal_format> classify_literal(std::string_view source) {
+        // order matters here, e.g. 0 is a decimal integer and 0x1p2 would otherwise start out as a hex integer
+        if(literal_scanner(source).binary_integer()) {
+            return literal_format::integer_binary;
+        } else if(literal_scanner(source).octal_integer()) {
+            return literal_format::integer_octal;
+        } else if(literal_scanner(source).decimal_integer()) {
+            return literal_format::default_format;
+        } else if(literal_scanner(source).hex_integer()) {
+            return literal_format::integer_hex;
+        } else if(literal_scanner(source).decimal_float()) {
+            return literal_format::default_format;
+        } else if(literal_scanner(source).hex_float()) {
+            return literal_format::float_hex;
+        } else if(literal_scanner(source).char_literal()) {
+            return literal_format::default_format;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    std::size_t escape_sequence_length(std::string_view source, std::size_t i) {
+        if(i + 1 >= source.size() || source[i] != '\\') {
+            return 0;
+        }
+        const char c = source[i + 1];
+        if(is_octal_digit(c)) {
+            std::size_t length = 2;
+            while(length < 4 && i + length < source.size() && is_octal_digit(source[i + length])) {
+                length++;
+            }
+            return length;
+        } else if(c == 'x' && i + 2 < source.size() && is_hex_digit(source[i + 2])) {
+            std::size_t length = 3;
+            while(i + length < source.size() && is_hex_digit(source[i + length])) {
+                length++;
+            }
+            return length;
+        } else if(c != '\n' && c != '\r') {
+            return 2;
+        } else {
+            return 0;
+        }
+    }
 }
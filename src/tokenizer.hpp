@@ -34,6 +34,15 @@ namespace libassert::detail {
     // data
     LIBASSERT_EXPORT_TESTING
     std::optional<std::vector<token_t>> tokenize(std::string_view source, bool decompose_shr = false);
+
+    // Classifies a complete numeric or character literal by the format it's written in. Returns nullopt if the source
+    // isn't exactly one literal.
+    LIBASSERT_EXPORT_TESTING
+    std::optional<literal_format> classify_literal(std::string_view source);
+
+    // Returns the length of the escape sequence starting at source[i], or 0 if there isn't one. Matches the escapes
+    // highlighted inside string and char literals: \ooo, \xhh..., and \ followed by any other non-newline character.
+    std::size_t escape_sequence_length(std::string_view source, std::size_t i);
 }
 
 #endif
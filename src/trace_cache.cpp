@@ -0,0 +1,150 @@
+#include "trace_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace libassert::detail {
+    namespace {
+        // once full, new entries are simply not added
+        constexpr std::size_t max_cached_traces = 256;
+        constexpr std::size_t max_cached_addresses = 16384;
+
+        struct cached_trace {
+            std::vector<cpptrace::frame_ptr> addresses; // to rule out hash collisions
+            cpptrace::stacktrace trace;
+        };
+
+        struct trace_cache {
+            std::mutex mutex;
+            std::unordered_map<std::uint64_t, cached_trace> traces;
+            // an address can resolve to several frames if there are inlined calls
+            std::unordered_map<cpptrace::frame_ptr, std::vector<cpptrace::stacktrace_frame>> frames;
+        };
+
+        trace_cache& get_trace_cache() {
+            static trace_cache cache;
+            return cache;
+        }
+
+        std::uint64_t hash_addresses(const cpptrace::frame_ptr* addresses, std::size_t count) {
+            // fnv-1a over the addresses
+            std::uint64_t hash = 0xcbf29ce484222325ULL;
+            for(std::size_t i = 0; i < count; i++) {
+                hash ^= static_cast<std::uint64_t>(addresses[i]);
+                hash *= 0x100000001b3ULL;
+            }
+            return hash;
+        }
+    }
+
+    LIBASSERT_ATTR_COLD
+    bool split_frames(
+        const std::vector<cpptrace::frame_ptr>& addresses,
+        cpptrace::stacktrace& trace,
+        std::unordered_map<cpptrace::frame_ptr, std::vector<cpptrace::stacktrace_frame>>& out
+    ) {
+        // inlined frames don't necessarily carry the address they were resolved from, so it isn't compared
+        bool lines_up = true;
+        std::size_t i = 0;
+        std::vector<cpptrace::stacktrace_frame>* last = nullptr;
+        for(const auto address : addresses) {
+            std::vector<cpptrace::stacktrace_frame> frames;
+            while(i < trace.frames.size()) {
+                const bool is_inline = trace.frames[i].is_inline;
+                frames.push_back(std::move(trace.frames[i++]));
+                if(!is_inline) {
+                    break;
+                }
+            }
+            if(frames.empty()) {
+                // ran out of frames, keep the address so the trace still has an entry for it
+                cpptrace::stacktrace_frame frame{};
+                frame.raw_address = address;
+                frame.is_inline = false;
+                frames.push_back(std::move(frame));
+                lines_up = false;
+            } else if(frames.back().is_inline) {
+                lines_up = false;
+            }
+            last = &out.insert_or_assign(address, std::move(frames)).first->second;
+        }
+        if(i != trace.frames.size()) {
+            lines_up = false;
+            if(last) {
+                last->insert(
+                    last->end(),
+                    std::make_move_iterator(trace.frames.begin() + static_cast<std::ptrdiff_t>(i)),
+                    std::make_move_iterator(trace.frames.end())
+                );
+            }
+        }
+        return lines_up;
+    }
+
+    LIBASSERT_ATTR_COLD
+    cpptrace::stacktrace resolve_cached(const cpptrace::raw_trace& raw_trace) {
+        return resolve_cached(raw_trace.frames.data(), raw_trace.frames.size());
+    }
+
+    LIBASSERT_ATTR_COLD
+    cpptrace::stacktrace resolve_cached(const cpptrace::frame_ptr* addresses, std::size_t count) {
+        auto& cache = get_trace_cache();
+        const auto hash = hash_addresses(addresses, count);
+        const auto addresses_end = addresses + count;
+        std::vector<cpptrace::frame_ptr> missing;
+        {
+            const std::unique_lock lock(cache.mutex);
+            auto it = cache.traces.find(hash);
+            if(
+                it != cache.traces.end()
+                && std::equal(it->second.addresses.begin(), it->second.addresses.end(), addresses, addresses_end)
+            ) {
+                return it->second.trace;
+            }
+            std::unordered_map<cpptrace::frame_ptr, bool> seen;
+            for(std::size_t i = 0; i < count; i++) {
+                const auto address = addresses[i];
+                if(cache.frames.count(address) == 0 && seen.emplace(address, true).second) {
+                    missing.push_back(address);
+                }
+            }
+        }
+        // symbolize what hasn't been seen before, in one batch and outside the lock
+        std::unordered_map<cpptrace::frame_ptr, std::vector<cpptrace::stacktrace_frame>> fresh;
+        bool cacheable = true;
+        if(!missing.empty()) {
+            auto resolved = cpptrace::raw_trace{missing}.resolve();
+            cacheable = split_frames(missing, resolved, fresh);
+        }
+        const std::unique_lock lock(cache.mutex);
+        cpptrace::stacktrace trace;
+        for(std::size_t i = 0; i < count; i++) {
+            const auto address = addresses[i];
+            auto it = cache.frames.find(address);
+            if(it == cache.frames.end()) {
+                // another thread may have resolved it in the meantime, in which case ours is dropped
+                auto fresh_it = fresh.find(address);
+                LIBASSERT_PRIMITIVE_ASSERT(fresh_it != fresh.end());
+                if(!cacheable || cache.frames.size() >= max_cached_addresses) {
+                    trace.frames.insert(trace.frames.end(), fresh_it->second.begin(), fresh_it->second.end());
+                    continue;
+                }
+                it = cache.frames.emplace(address, std::move(fresh_it->second)).first;
+                fresh.erase(fresh_it);
+            }
+            trace.frames.insert(trace.frames.end(), it->second.begin(), it->second.end());
+        }
+        if(cacheable && cache.traces.size() < max_cached_traces) {
+            cache.traces.insert_or_assign(hash, cached_trace{{addresses, addresses_end}, trace});
+        }
+        return trace;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef TRACE_CACHE_HPP
+#define TRACE_CACHE_HPP
+
+#if defined(__has_include) && __has_include(<cpptrace/basic.hpp>)
+ #include <cpptrace/basic.hpp>
+#else
+ #include <cpptrace/cpptrace.hpp>
+#endif
+
+#include <unordered_map>
+#include <vector>
+
+#include <libassert/platform.hpp>
+
+#include "common.hpp"
+
+namespace libassert::detail {
+    // Equivalent to raw_trace.resolve() but reuses symbolization from earlier failures. Whole traces are cached by their
+    // addresses and individual addresses are cached so only frames that haven't been seen before are resolved.
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
+    cpptrace::stacktrace resolve_cached(const cpptrace::raw_trace& raw_trace);
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
+    cpptrace::stacktrace resolve_cached(const cpptrace::frame_ptr* addresses, std::size_t count);
+
+    // Splits a trace resolved from addresses back up by address. Frames are attributed by position: each address gets
+    // the run of inlined frames followed by the frame they were inlined into. Returns false if the frames don't line
+    // up with the addresses, in which case every address still gets frames but they shouldn't be cached.
+    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
+    bool split_frames(
+        const std::vector<cpptrace::frame_ptr>& addresses,
+        cpptrace::stacktrace& trace,
+        std::unordered_map<cpptrace::frame_ptr, std::vector<cpptrace::stacktrace_frame>>& out
+    );
+}
+
+#endif
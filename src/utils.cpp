@@ -1,7 +1,6 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
-#include <regex>
 #include <string_view>
 #include <string>
 #include <utility>
@@ -129,17 +128,6 @@ namespace libassert::detail {
         }
     }
 
-    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
-    void replace_all(std::string& str, const std::regex& re, std::string_view replacement) {
-        std::smatch match;
-        std::size_t i = 0;
-        // NOLINTNEXTLINE(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions)
-        while(std::regex_search(str.cbegin() + i, str.cend(), match, re)) {
-            str.replace(i + match.position(), match.length(), replacement);
-            i += match.position() + replacement.length();
-        }
-    }
-
     LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
     void replace_all(std::string& str, std::string_view substr, std::string_view replacement) {
         std::string::size_type pos = 0;
@@ -150,29 +138,6 @@ namespace libassert::detail {
         }
     }
 
-    LIBASSERT_ATTR_COLD
-    void replace_all_template(std::string& str, const std::pair<std::regex, std::string_view>& rule) {
-        const auto& [re, replacement] = rule;
-        std::smatch match;
-        std::size_t cursor = 0;
-        // NOLINTNEXTLINE(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions)
-        while(std::regex_search(str.cbegin() + cursor, str.cend(), match, re)) {
-            // find matching >
-            const std::size_t match_begin = cursor + match.position();
-            std::size_t end = match_begin + match.length();
-            for(int c = 1; end < str.size() && c > 0; end++) {
-                if(str[end] == '<') {
-                    c++;
-                } else if(str[end] == '>') {
-                    c--;
-                }
-            }
-            // make the replacement
-            str.replace(match_begin, end - match_begin, replacement);
-            cursor = match_begin + replacement.length();
-        }
-    }
-
     LIBASSERT_ATTR_COLD
     std::string indent(const std::string_view str, size_t depth, char c, bool ignore_first) {
         size_t i = 0;
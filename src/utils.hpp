@@ -6,7 +6,6 @@
 #include <cstdio>
 #include <iterator>
 #include <optional>
-#include <regex>
 #include <string_view>
 #include <string>
 #include <utility>
@@ -69,14 +68,36 @@ namespace libassert::detail {
     LIBASSERT_ATTR_COLD
     void replace_all_dynamic(std::string& str, std::string_view text, std::string_view replacement);
 
-    LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
-    void replace_all(std::string& str, const std::regex& re, std::string_view replacement);
-
     LIBASSERT_ATTR_COLD LIBASSERT_EXPORT_TESTING
     void replace_all(std::string& str, std::string_view substr, std::string_view replacement);
 
+    // Replaces template-ids whose name is matched by matcher, through the closing >, with replacement. matcher(str, i)
+    // should return the length of the match at i, including the opening <, or 0 if there isn't one.
+    template<typename F>
     LIBASSERT_ATTR_COLD
-    void replace_all_template(std::string& str, const std::pair<std::regex, std::string_view>& rule);
+    void replace_all_template(std::string& str, const F& matcher, std::string_view replacement) {
+        std::size_t cursor = 0;
+        while(cursor < str.size()) {
+            const std::size_t length = matcher(std::string_view(str), cursor);
+            if(length == 0) {
+                cursor++;
+                continue;
+            }
+            // find matching >
+            const std::size_t match_begin = cursor;
+            std::size_t end = match_begin + length;
+            for(int c = 1; end < str.size() && c > 0; end++) {
+                if(str[end] == '<') {
+                    c++;
+                } else if(str[end] == '>') {
+                    c--;
+                }
+            }
+            // make the replacement
+            str.replace(match_begin, end - match_begin, replacement);
+            cursor = match_begin + replacement.length();
+        }
+    }
 
     LIBASSERT_ATTR_COLD
     std::string indent(std::string_view str, size_t depth, char c = ' ', bool ignore_first = false);
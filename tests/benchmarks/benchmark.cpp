@@ -0,0 +1,596 @@
+// libassert-bench: cost of passing assertions and of the failure path
+//
+// usage: libassert-bench [--format=text|json] [--filter=substring] [--min-time=seconds]
+//
+// Passing assertions are compared against no check and against assert(). Failure latency is broken down into phases:
+// trace capture, trace resolution, operand stringification, expression decomposition, report formatting, and writing.
+// Resolution is reported both through libassert's trace cache (what repeated failures at one site cost) and uncached.
+// String escaping throughput is compared between the old byte-at-a-time loop and each of the scanners in escape.hpp,
+// and number formatting between iostreams and number_format.hpp. Range assertions are compared against an assertion per
+// element in a loop.
+
+// assert() is the baseline being compared against, keep it enabled in release builds
+#undef NDEBUG
+#include <atomic>
+#include <bitset>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string_view>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <libassert/assert.hpp>
+#include <libassert/version.hpp>
+
+#include "benchmark.hpp"
+#include "escape.hpp"
+#include "number_format.hpp"
+
+namespace bench {
+    namespace {
+        #ifdef _WIN32
+         constexpr const char* null_device = "NUL";
+        #else
+         constexpr const char* null_device = "/dev/null";
+        #endif
+
+        // ---- passing assertions ----
+
+        template<typename T, typename Op>
+        void passing_benchmarks(
+            const options& opts,
+            results& out,
+            const std::string& type,
+            T a,
+            T b,
+            Op
+        ) {
+            const auto run = [&](const std::string& kind, auto&& op) {
+                const std::string name = "passing/" + type + "/" + kind;
+                if(name.find(opts.filter) == std::string::npos) {
+                    return;
+                }
+                out.add(name, measure_ns(opts, op), "ns/op");
+            };
+            run("none", [&] {
+                make_opaque(a);
+                make_opaque(b);
+                do_not_optimize(Op{}(a, b));
+            });
+            run("assert", [&] {
+                make_opaque(a);
+                make_opaque(b);
+                assert(Op{}(a, b));
+            });
+            run("ASSERT", [&] {
+                make_opaque(a);
+                make_opaque(b);
+                LIBASSERT_ASSERT(Op{}(a, b));
+            });
+            // decomposed form, the operands are captured by the expression template
+            if constexpr(std::is_same_v<Op, std::less<>>) {
+                run("ASSERT_decomposed", [&] {
+                    make_opaque(a);
+                    make_opaque(b);
+                    LIBASSERT_ASSERT(a < b);
+                });
+                run("ASSERT_VAL", [&] {
+                    make_opaque(a);
+                    make_opaque(b);
+                    do_not_optimize(LIBASSERT_ASSERT_VAL(a < b));
+                });
+            } else {
+                run("ASSERT_decomposed", [&] {
+                    make_opaque(a);
+                    make_opaque(b);
+                    LIBASSERT_ASSERT(a != b);
+                });
+                run("ASSERT_VAL", [&] {
+                    make_opaque(a);
+                    make_opaque(b);
+                    do_not_optimize(LIBASSERT_ASSERT_VAL(a != b));
+                });
+            }
+        }
+
+        // an assertion per element against the range assertions, for a range of 4096 floats
+        void run_passing_range(const options& opts, results& out) {
+            std::vector<float> values(4096);
+            for(std::size_t i = 0; i < values.size(); i++) {
+                values[i] = static_cast<float>(i % 100) / 100;
+            }
+            const auto run = [&](const std::string& kind, auto&& op) {
+                const std::string name = "passing/range/" + kind;
+                if(name.find(opts.filter) == std::string::npos) {
+                    return;
+                }
+                out.add(name, measure_ns(opts, op), "ns/op");
+            };
+            run("loop_ASSERT", [&] {
+                make_opaque(values);
+                for(const float value : values) {
+                    LIBASSERT_ASSERT(value >= 0 && value <= 1);
+                }
+            });
+            run("ASSERT_ALL", [&] {
+                make_opaque(values);
+                LIBASSERT_ASSERT_ALL(values, [](float value) { return (value >= 0) & (value <= 1); });
+            });
+            run("ASSERT_ALL_IN_RANGE", [&] {
+                make_opaque(values);
+                LIBASSERT_ASSERT_ALL_IN_RANGE(values, 0, 1);
+            });
+            run("loop_ASSERT_not_nan", [&] {
+                make_opaque(values);
+                for(const float value : values) {
+                    LIBASSERT_ASSERT(value == value);
+                }
+            });
+            run("ASSERT_NONE_NAN", [&] {
+                make_opaque(values);
+                LIBASSERT_ASSERT_NONE_NAN(values);
+            });
+        }
+
+        void run_passing(const options& opts, results& out) {
+            passing_benchmarks(opts, out, "int", 1, 2, std::less<>{});
+            passing_benchmarks(opts, out, "double", 1.5, 2.5, std::less<>{});
+            passing_benchmarks(opts, out, "string", std::string("foobar"), std::string("foobaz"), std::not_equal_to<>{});
+            int x = 0;
+            passing_benchmarks(opts, out, "pointer", &x, static_cast<int*>(nullptr), std::not_equal_to<>{});
+            run_passing_range(opts, out);
+        }
+
+        // ---- failure path ----
+
+        void noop_handler(const libassert::assertion_info&) {}
+
+        struct phase_totals {
+            double resolve = 0;
+            double decompose = 0;
+            double format = 0;
+            double write = 0;
+            std::size_t count = 0;
+        };
+
+        phase_totals phases;
+        std::FILE* null_file = nullptr;
+
+        // Performs the work of a reporting failure handler, timing each phase
+        void phase_handler(const libassert::assertion_info& info) {
+            using clock = std::chrono::steady_clock;
+            using ns = std::chrono::duration<double, std::nano>;
+            const auto& scheme = libassert::color_scheme::blank;
+            const auto t0 = clock::now();
+            do_not_optimize(info.get_stacktrace());
+            const auto t1 = clock::now();
+            const auto diagnostics = info.print_binary_diagnostics(80, scheme);
+            const auto t2 = clock::now();
+            std::string report = info.tagline(scheme);
+            report += info.location();
+            report += info.statement(scheme);
+            report += diagnostics;
+            report += info.print_extra_diagnostics(80, scheme);
+            report += info.print_stacktrace(80, scheme);
+            const auto t3 = clock::now();
+            std::fwrite(report.data(), 1, report.size(), null_file);
+            std::fflush(null_file);
+            const auto t4 = clock::now();
+            phases.resolve += ns(t1 - t0).count();
+            phases.decompose += ns(t2 - t1).count();
+            phases.format += ns(t3 - t2).count();
+            phases.write += ns(t4 - t3).count();
+            phases.count++;
+        }
+
+        // stringified through its operator<<
+        struct point {
+            int x;
+            int y;
+        };
+
+        std::ostream& operator<<(std::ostream& os, const point& p) {
+            return os<<"("<<p.x<<", "<<p.y<<")";
+        }
+
+        LIBASSERT_ATTR_NOINLINE void failing_assertion(int a, int b) {
+            LIBASSERT_ASSERT(a == b, "benchmark failure", a + b);
+        }
+
+        void run_failure(const options& opts, results& out) {
+            const auto enabled = [&](const char* name) {
+                return std::string_view(name).find(opts.filter) != std::string_view::npos;
+            };
+            int a = 1;
+            int b = 2;
+            const auto previous_handler = libassert::get_failure_handler();
+            if(enabled("failure/total/noop_handler")) {
+                libassert::set_failure_handler(noop_handler);
+                out.add("failure/total/noop_handler", measure_ns(opts, [&] {
+                    make_opaque(a);
+                    failing_assertion(a, b);
+                }), "ns/op");
+            }
+            if(enabled("failure/capture")) {
+                out.add("failure/capture", measure_ns(opts, [] {
+                    do_not_optimize(cpptrace::generate_raw_trace());
+                }), "ns/op");
+            }
+            if(enabled("failure/resolve_uncached")) {
+                const auto raw = cpptrace::generate_raw_trace();
+                out.add("failure/resolve_uncached", measure_ns(opts, [&] {
+                    do_not_optimize(raw.resolve());
+                }), "ns/op");
+            }
+            if(enabled("failure/stringify")) {
+                const std::vector<int> vec{1, 2, 3, 4, 5, 6, 7, 8};
+                const std::string str = "the quick brown fox\tjumps over the lazy dog\n";
+                double d = 0.1;
+                out.add("failure/stringify/int", measure_ns(opts, [&] {
+                    make_opaque(a);
+                    do_not_optimize(libassert::stringify(a));
+                }), "ns/op");
+                out.add("failure/stringify/double", measure_ns(opts, [&] {
+                    make_opaque(d);
+                    do_not_optimize(libassert::stringify(d));
+                }), "ns/op");
+                out.add("failure/stringify/string", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::stringify(str));
+                }), "ns/op");
+                out.add("failure/stringify/vector", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::stringify(vec));
+                }), "ns/op");
+                const std::vector<std::vector<std::string>> nested(16, std::vector<std::string>(16, "element"));
+                out.add("failure/stringify/nested", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::stringify(nested));
+                }), "ns/op");
+                const std::vector<point> points(64, point{12, 34});
+                out.add("failure/stringify/ostream", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::stringify(points));
+                }), "ns/op");
+            }
+            if(enabled("failure/range_diff")) {
+                // == on two 100k element vectors, summarized versus stringifying both in full
+                std::vector<int> left(100000);
+                for(std::size_t i = 0; i < left.size(); i++) {
+                    left[i] = static_cast<int>(i);
+                }
+                auto right = left;
+                right[50000] = -1;
+                out.add("failure/range_diff/full", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::detail::generate_stringification(left));
+                    do_not_optimize(libassert::detail::generate_stringification(right));
+                }), "ns/op");
+                out.add("failure/range_diff/diff", measure_ns(opts, [&] {
+                    do_not_optimize(libassert::detail::generate_binary_diagnostic(left, right, "left", "right", "=="));
+                }), "ns/op");
+            }
+            if(enabled("failure/phase")) {
+                null_file = std::fopen(null_device, "wb");
+                if(null_file) {
+                    libassert::set_failure_handler(phase_handler);
+                    phases = {};
+                    const double total = measure_ns(opts, [&] {
+                        make_opaque(a);
+                        failing_assertion(a, b);
+                    });
+                    const auto n = static_cast<double>(phases.count);
+                    out.add("failure/phase/resolve", phases.resolve / n, "ns/op");
+                    out.add("failure/phase/decompose", phases.decompose / n, "ns/op");
+                    out.add("failure/phase/format", phases.format / n, "ns/op");
+                    out.add("failure/phase/write", phases.write / n, "ns/op");
+                    out.add("failure/phase/total", total, "ns/op");
+                    std::fclose(null_file);
+                    null_file = nullptr;
+                }
+            }
+            libassert::set_failure_handler(previous_handler);
+        }
+
+        // ---- multi-threaded failure throughput ----
+
+        void run_throughput(const options& opts, results& out) {
+            const auto previous_handler = libassert::get_failure_handler();
+            libassert::set_failure_handler(noop_handler);
+            for(unsigned n_threads : {1u, 2u, 4u, 8u}) {
+                const std::string name = "throughput/threads=" + std::to_string(n_threads);
+                if(name.find(opts.filter) == std::string::npos) {
+                    continue;
+                }
+                std::atomic<bool> start{false};
+                std::atomic<bool> stop{false};
+                std::atomic<std::size_t> total{0};
+                std::vector<std::thread> threads;
+                for(unsigned i = 0; i < n_threads; i++) {
+                    threads.emplace_back([&] {
+                        int a = 1;
+                        int b = 2;
+                        while(!start.load(std::memory_order_acquire)) {}
+                        std::size_t count = 0;
+                        while(!stop.load(std::memory_order_relaxed)) {
+                            make_opaque(a);
+                            failing_assertion(a, b);
+                            count++;
+                        }
+                        total += count;
+                    });
+                }
+                const auto begin = std::chrono::steady_clock::now();
+                start.store(true, std::memory_order_release);
+                std::this_thread::sleep_for(std::chrono::duration<double>(opts.min_time));
+                stop = true;
+                for(auto& thread : threads) {
+                    thread.join();
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+                out.add(name, static_cast<double>(total) / elapsed.count(), "failures/s");
+            }
+            libassert::set_failure_handler(previous_handler);
+        }
+
+        // ---- string escaping ----
+
+        // The byte-at-a-time escaping loop stringification used before the vectorized scan, as a baseline
+        std::string escape_byte_loop(std::string_view str, char quote) {
+            std::string escaped;
+            escaped += quote;
+            for(const char c : str) {
+                if(c == '\\') escaped += "\\\\";
+                else if(c == '\t') escaped += "\\t";
+                else if(c == '\r') escaped += "\\r";
+                else if(c == '\n') escaped += "\\n";
+                else if(c == quote) escaped += std::initializer_list<char>{'\\', quote};
+                else if(c >= 32 && c <= 126) escaped += c; // printable
+                else {
+                    constexpr const char * const hexdig = "0123456789abcdef";
+                    const auto byte = static_cast<unsigned char>(c);
+                    escaped += std::string("\\x") + hexdig[byte >> 4] + hexdig[byte & 0xF];
+                }
+            }
+            escaped += quote;
+            return escaped;
+        }
+
+        std::string escape_with(std::string_view str, char quote, libassert::detail::escape_scanner scan) {
+            std::string escaped;
+            escaped.reserve(str.size() + 2);
+            escaped += quote;
+            libassert::detail::append_escaped(escaped, str, quote, scan);
+            escaped += quote;
+            return escaped;
+        }
+
+        void run_escape(const options& opts, results& out) {
+            // a 64KiB buffer of printable text, and the same with a newline every 80 bytes like a text blob
+            std::string clean(64 * 1024, ' ');
+            for(std::size_t i = 0; i < clean.size(); i++) {
+                clean[i] = static_cast<char>('a' + i % 26);
+            }
+            std::string lines = clean;
+            for(std::size_t i = 79; i < lines.size(); i += 80) {
+                lines[i] = '\n';
+            }
+            const auto mb_per_s = [](std::size_t bytes, double ns) {
+                return static_cast<double>(bytes) / ns * 1e3;
+            };
+            for(const auto& [input_name, input] : {std::pair{"clean", &clean}, std::pair{"lines", &lines}}) {
+                const auto run = [&, &input = input, &input_name = input_name](const std::string& kind, auto&& op) {
+                    const std::string name = std::string("escape/") + input_name + "/" + kind;
+                    if(name.find(opts.filter) == std::string::npos) {
+                        return;
+                    }
+                    out.add(name, mb_per_s(input->size(), measure_ns(opts, op)), "MB/s");
+                };
+                const std::string_view str = *input;
+                run("byte_loop", [&] { do_not_optimize(escape_byte_loop(str, '"')); });
+                run("scalar", [&] { do_not_optimize(escape_with(str, '"', libassert::detail::find_escape_scalar)); });
+                #if LIBASSERT_ESCAPE_X86
+                 run("sse2", [&] { do_not_optimize(escape_with(str, '"', libassert::detail::find_escape_sse2)); });
+                 if(libassert::detail::cpu_supports_avx2()) {
+                     run("avx2", [&] { do_not_optimize(escape_with(str, '"', libassert::detail::find_escape_avx2)); });
+                 } else {
+                     out.add_unavailable(std::string("escape/") + input_name + "/avx2", "MB/s");
+                 }
+                #endif
+            }
+        }
+
+        // ---- number formatting ----
+
+        // The iostream formatting stringification used before number_format.hpp, as a baseline
+        template<typename T>
+        std::string format_integer_iostream(T value, libassert::literal_format format) {
+            std::ostringstream oss;
+            switch(format) {
+                case libassert::literal_format::integer_hex:
+                    oss<<std::showbase<<std::hex;
+                    break;
+                case libassert::literal_format::integer_octal:
+                    oss<<std::showbase<<std::oct;
+                    break;
+                case libassert::literal_format::integer_binary:
+                    oss<<"0b"<<std::bitset<sizeof(value) * 8>(value);
+                    return std::move(oss).str();
+                default:
+                    break;
+            }
+            oss<<value;
+            return std::move(oss).str();
+        }
+
+        template<typename T>
+        std::string format_floating_point_iostream(T value, bool hex) {
+            std::ostringstream oss;
+            if(hex) {
+                oss<<std::hexfloat;
+            }
+            oss<<std::setprecision(std::numeric_limits<T>::max_digits10)<<value;
+            std::string s = std::move(oss).str();
+            if(s.find('.') == std::string::npos) {
+                s += ".0";
+            }
+            return s;
+        }
+
+        template<typename T>
+        std::string format_integer_to_chars(T value, libassert::literal_format format) {
+            std::string out;
+            switch(format) {
+                case libassert::literal_format::integer_hex:
+                    libassert::detail::append_hex(out, value);
+                    break;
+                case libassert::literal_format::integer_octal:
+                    libassert::detail::append_octal(out, value);
+                    break;
+                case libassert::literal_format::integer_binary:
+                    libassert::detail::append_binary(out, value);
+                    break;
+                default:
+                    libassert::detail::append_decimal(out, value);
+                    break;
+            }
+            return out;
+        }
+
+        template<typename T>
+        std::string format_floating_point_to_chars(T value, bool hex) {
+            std::string out;
+            libassert::detail::append_floating_point(out, value, hex);
+            return out;
+        }
+
+        void run_number_format(const options& opts, results& out) {
+            // numbers of all magnitudes, formatted 1000 at a time like the elements of a large numeric array
+            std::vector<long long> integers(1000);
+            std::vector<double> doubles(1000);
+            for(std::size_t i = 0; i < integers.size(); i++) {
+                integers[i] = static_cast<long long>(i * i * i * 2654435761ull) >> (i % 48);
+                doubles[i] = static_cast<double>(integers[i]) / 7.0;
+            }
+            const auto run = [&](const std::string& name, auto&& op) {
+                if(name.find(opts.filter) == std::string::npos) {
+                    return;
+                }
+                out.add(name, measure_ns(opts, op) / 1000, "ns/number");
+            };
+            for(const auto& [format_name, format] : {
+                std::pair{"decimal", libassert::literal_format::default_format},
+                std::pair{"hex", libassert::literal_format::integer_hex},
+                std::pair{"octal", libassert::literal_format::integer_octal},
+                std::pair{"binary", libassert::literal_format::integer_binary}
+            }) {
+                const std::string prefix = std::string("format/integer/") + format_name;
+                run(prefix + "/iostream", [&, format = format] {
+                    for(const auto value : integers) {
+                        do_not_optimize(format_integer_iostream(value, format));
+                    }
+                });
+                run(prefix + "/to_chars", [&, format = format] {
+                    for(const auto value : integers) {
+                        do_not_optimize(format_integer_to_chars(value, format));
+                    }
+                });
+            }
+            for(const bool hex : {false, true}) {
+                const std::string prefix = std::string("format/double/") + (hex ? "hexfloat" : "default");
+                run(prefix + "/iostream", [&] {
+                    for(const auto value : doubles) {
+                        do_not_optimize(format_floating_point_iostream(value, hex));
+                    }
+                });
+                run(prefix + "/to_chars", [&] {
+                    for(const auto value : doubles) {
+                        do_not_optimize(format_floating_point_to_chars(value, hex));
+                    }
+                });
+            }
+        }
+
+        // ---- output ----
+
+        void print_text(const results& out) {
+            std::printf("libassert %d.%d.%d\n", LIBASSERT_VERSION_MAJOR, LIBASSERT_VERSION_MINOR, LIBASSERT_VERSION_PATCH);
+            for(const auto& entry : out.get()) {
+                if(entry.available) {
+                    std::printf("%-40s %14.2f %s\n", entry.name.c_str(), entry.value, entry.unit.c_str());
+                } else {
+                    std::printf("%-40s %14s %s\n", entry.name.c_str(), "n/a", entry.unit.c_str());
+                }
+            }
+        }
+
+        void print_json(const results& out, const options& opts) {
+            std::printf(
+                "{\"library_version\":\"%d.%d.%d\",\"min_time\":%g,\"results\":[",
+                LIBASSERT_VERSION_MAJOR,
+                LIBASSERT_VERSION_MINOR,
+                LIBASSERT_VERSION_PATCH,
+                opts.min_time
+            );
+            bool first = true;
+            for(const auto& entry : out.get()) {
+                std::printf("%s{\"name\":\"%s\",\"value\":", first ? "" : ",", entry.name.c_str());
+                if(entry.available) {
+                    std::printf("%.6g", entry.value);
+                } else {
+                    std::printf("null");
+                }
+                std::printf(",\"unit\":\"%s\"}", entry.unit.c_str());
+                first = false;
+            }
+            std::printf("]}\n");
+        }
+
+        [[noreturn]] void usage(const char* argv0) {
+            std::fprintf(stderr, "usage: %s [--format=text|json] [--filter=substring] [--min-time=seconds]\n", argv0);
+            std::exit(2);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::options opts;
+    bool json = false;
+    for(int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const auto value_of = [&](std::string_view flag) {
+            return arg.substr(flag.size());
+        };
+        if(arg == "--format=json") {
+            json = true;
+        } else if(arg == "--format=text") {
+            json = false;
+        } else if(arg.rfind("--filter=", 0) == 0) {
+            opts.filter = std::string(value_of("--filter="));
+        } else if(arg.rfind("--min-time=", 0) == 0) {
+            opts.min_time = std::atof(std::string(value_of("--min-time=")).c_str());
+            if(opts.min_time <= 0) {
+                bench::usage(argv[0]);
+            }
+        } else {
+            bench::usage(argv[0]);
+        }
+    }
+    bench::results out;
+    bench::report_code_size(opts, out);
+    bench::run_passing(opts, out);
+    bench::run_failure(opts, out);
+    bench::run_throughput(opts, out);
+    bench::run_escape(opts, out);
+    bench::run_number_format(opts, out);
+    if(json) {
+        bench::print_json(out, opts);
+    } else {
+        bench::print_text(out);
+    }
+}
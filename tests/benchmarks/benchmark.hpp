@@ -0,0 +1,85 @@
+#ifndef LIBASSERT_BENCHMARK_HPP
+#define LIBASSERT_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+ #include <intrin.h>
+#endif
+
+namespace bench {
+    // Keeps a value alive as far as the optimizer is concerned
+    template<typename T>
+    inline void do_not_optimize(const T& value) {
+        #ifdef _MSC_VER
+         const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+         (void)*sink;
+         _ReadWriteBarrier();
+        #else
+         asm volatile("" : : "r,m"(value) : "memory");
+        #endif
+    }
+
+    // Forces a value to be reloaded from memory, so checks on it can't be hoisted out of the benchmark loop
+    template<typename T>
+    inline void make_opaque(T& value) {
+        #ifdef _MSC_VER
+         volatile char* sink = reinterpret_cast<volatile char*>(&value);
+         *sink = *sink;
+         _ReadWriteBarrier();
+        #else
+         asm volatile("" : "+m"(value) : : "memory");
+        #endif
+    }
+
+    struct result {
+        std::string name;
+        double value;
+        std::string unit;
+        bool available;
+    };
+
+    class results {
+        std::vector<result> entries;
+    public:
+        void add(std::string name, double value, std::string unit) {
+            entries.push_back({std::move(name), value, std::move(unit), true});
+        }
+        void add_unavailable(std::string name, std::string unit) {
+            entries.push_back({std::move(name), 0, std::move(unit), false});
+        }
+        const std::vector<result>& get() const {
+            return entries;
+        }
+    };
+
+    struct options {
+        std::string filter;
+        double min_time = 0.25; // seconds per benchmark
+    };
+
+    // Runs op in batches of growing size until a batch takes at least min_time, returns the mean ns per call
+    template<typename F>
+    double measure_ns(const options& opts, F&& op) {
+        using clock = std::chrono::steady_clock;
+        const auto min_time = std::chrono::duration<double>(opts.min_time);
+        for(std::size_t iterations = 1; ; iterations *= 2) {
+            const auto start = clock::now();
+            for(std::size_t i = 0; i < iterations; i++) {
+                op();
+            }
+            const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+            if(elapsed >= min_time || iterations >= (std::size_t(1) << 40)) {
+                return elapsed.count() / static_cast<double>(iterations);
+            }
+        }
+    }
+
+    void report_code_size(const options& opts, results& out);
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Call-site code size of passing assertions, see code_size.hpp. Sizes aren't reported on targets without section
+// bounds. The out-of-line failure path is not counted, it's shared per assertion type and operands. The
+// LIBASSERT_COMPACT_CODEGEN variant is in code_size_compact.cpp since the mode applies to a whole translation unit.
+
+// assert() is the baseline being compared against, keep it enabled in release builds
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include <libassert/assert.hpp>
+
+#include "benchmark.hpp"
+#include "code_size.hpp"
+
+#define BENCH_NONE(expr) bench::do_not_optimize(expr)
+#define BENCH_CASSERT(expr) assert(expr)
+#define BENCH_LIBASSERT(expr) LIBASSERT_ASSERT(expr)
+
+BENCH_VARIANT(none, BENCH_NONE)
+BENCH_VARIANT(cassert, BENCH_CASSERT)
+BENCH_VARIANT(libassert, BENCH_LIBASSERT)
+
+#if BENCH_SECTIONS
+ #define BENCH_DECLARE_BOUNDS(name) extern "C" const char __start_##name[]; extern "C" const char __stop_##name[];
+ BENCH_DECLARE_BOUNDS(bench_size_int_none)
+ BENCH_DECLARE_BOUNDS(bench_size_int_cassert)
+ BENCH_DECLARE_BOUNDS(bench_size_int_libassert)
+ BENCH_DECLARE_BOUNDS(bench_size_int_compact)
+ BENCH_DECLARE_BOUNDS(bench_size_string_none)
+ BENCH_DECLARE_BOUNDS(bench_size_string_cassert)
+ BENCH_DECLARE_BOUNDS(bench_size_string_libassert)
+ BENCH_DECLARE_BOUNDS(bench_size_string_compact)
+ #define BENCH_SECTION_SIZE(name) std::optional<std::size_t>(static_cast<std::size_t>(__stop_##name - __start_##name))
+#else
+ #define BENCH_SECTION_SIZE(name) std::optional<std::size_t>()
+#endif
+
+namespace bench {
+    void report_code_size(const options& opts, results& out) {
+        constexpr double checks_per_function = 16;
+        const auto report = [&](const std::string& name, std::optional<std::size_t> size) {
+            if(name.find(opts.filter) == std::string::npos) {
+                return;
+            }
+            if(size) {
+                out.add(name, static_cast<double>(*size) / checks_per_function, "bytes/assertion");
+            } else {
+                out.add_unavailable(name, "bytes/assertion");
+            }
+        };
+        report("code_size/int/none", BENCH_SECTION_SIZE(bench_size_int_none));
+        report("code_size/int/assert", BENCH_SECTION_SIZE(bench_size_int_cassert));
+        report("code_size/int/ASSERT", BENCH_SECTION_SIZE(bench_size_int_libassert));
+        report("code_size/int/ASSERT_compact", BENCH_SECTION_SIZE(bench_size_int_compact));
+        report("code_size/string/none", BENCH_SECTION_SIZE(bench_size_string_none));
+        report("code_size/string/assert", BENCH_SECTION_SIZE(bench_size_string_cassert));
+        report("code_size/string/ASSERT", BENCH_SECTION_SIZE(bench_size_string_libassert));
+        report("code_size/string/ASSERT_compact", BENCH_SECTION_SIZE(bench_size_string_compact));
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef LIBASSERT_BENCHMARK_CODE_SIZE_HPP
+#define LIBASSERT_BENCHMARK_CODE_SIZE_HPP
+
+// Each code size variant's checks are put in their own section so the linker-provided __start_/__stop_ symbols give
+// the exact size. Only ELF targets with a GNU-compatible linker support this.
+
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+ #define BENCH_SECTIONS 1
+ #define BENCH_SECTION(name) __attribute__((section(#name), noinline, used))
+#else
+ #define BENCH_SECTIONS 0
+ #define BENCH_SECTION(name)
+#endif
+
+#define BENCH_CHECKS_4(check, a, b) check(a[0] < b); check(a[1] < b); check(a[2] < b); check(a[3] < b);
+#define BENCH_CHECKS_16(check, a, b) \
+    BENCH_CHECKS_4(check, a, b) BENCH_CHECKS_4(check, a, b) BENCH_CHECKS_4(check, a, b) BENCH_CHECKS_4(check, a, b)
+
+#define BENCH_VARIANT(kind, check) \
+    BENCH_SECTION(bench_size_int_##kind) void size_int_##kind(const int* a, int b) { \
+        BENCH_CHECKS_16(check, a, b) \
+    } \
+    BENCH_SECTION(bench_size_string_##kind) void size_string_##kind(const std::string* a, const std::string& b) { \
+        BENCH_CHECKS_16(check, a, b) \
+    }
+
+#endif
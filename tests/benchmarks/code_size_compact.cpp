@@ -0,0 +1,12 @@
+// Call-site code size of passing assertions with LIBASSERT_COMPACT_CODEGEN, reported from code_size.cpp
+
+#define LIBASSERT_COMPACT_CODEGEN
+#include <string>
+
+#include <libassert/assert.hpp>
+
+#include "code_size.hpp"
+
+#define BENCH_COMPACT(expr) LIBASSERT_ASSERT(expr)
+
+BENCH_VARIANT(compact, BENCH_COMPACT)
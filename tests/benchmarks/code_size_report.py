@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# Reports the code size libassert contributes to object files or binaries, using nm.
+#
+# usage: code_size_report.py [--json] [--top N] [--nm NM] file...
+#
+# Per instantiation: libassert templates grouped by name, with the number of distinct instantiations and their size.
+# Instantiations emitted in several object files are counted once, copies shows how often they were emitted before the
+# linker deduplicated them.
+# Per site: the static data of each assertion site (arg strings and parameters), grouped by the enclosing function,
+# together with the size of the function's out of line cold code which on gcc holds the inline failure paths.
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+TEXT_TYPES = set("tTwWi")
+DATA_TYPES = set("dDrRbBvVu")
+SITE_DATA = ("::_libassert_params", "::libassert_arg_strings")
+CLONE = re.compile(r" \[clone [^\]]*\]")
+COLD = re.compile(r"^(.*?)(?: \[clone \.cold[^\]]*\]|\.cold(?:\.\d+)?)$")
+
+
+def read_symbols(nm, path):
+    try:
+        out = subprocess.run(
+            [nm, "-C", "-S", "--size-sort", path],
+            check=True,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            universal_newlines=True,
+        ).stdout
+    except subprocess.CalledProcessError as e:
+        sys.exit("{} failed on {}: {}".format(nm, path, e.stderr.strip()))
+    for line in out.splitlines():
+        parts = line.split(" ", 3)
+        if len(parts) != 4:
+            continue
+        _, size, kind, name = parts
+        yield int(size, 16), kind, name
+
+
+def split_function_name(symbol):
+    # returns (qualified name without template arguments, is template) for a demangled function symbol
+    symbol = CLONE.sub("", symbol)
+    depth = 0
+    end = None
+    for i, c in enumerate(symbol):
+        if c == "<":
+            depth += 1
+        elif c == ">":
+            depth -= 1
+        elif c == "(" and depth == 0:
+            end = i
+            break
+    head = symbol if end is None else symbol[:end]
+    is_template = False
+    if head.endswith(">"):
+        is_template = True
+        depth = 0
+        for i in range(len(head) - 1, -1, -1):
+            if head[i] == ">":
+                depth += 1
+            elif head[i] == "<":
+                depth -= 1
+                if depth == 0:
+                    head = head[:i]
+                    break
+    # drop the return type
+    depth = 0
+    start = 0
+    for i, c in enumerate(head):
+        if c == "<":
+            depth += 1
+        elif c == ">":
+            depth -= 1
+        elif c == " " and depth == 0:
+            start = i + 1
+    return head[start:], is_template
+
+
+def site_function(symbol):
+    for suffix in SITE_DATA:
+        if symbol.endswith(suffix):
+            symbol = symbol[: -len(suffix)]
+            break
+    lambda_start = symbol.find("::{lambda")
+    if lambda_start != -1:
+        symbol = symbol[:lambda_start]
+    return symbol
+
+
+def analyze(nm, paths):
+    instantiations = defaultdict(lambda: {"symbols": {}, "copies": 0})
+    sites = defaultdict(lambda: {"sites": 0, "data_bytes": 0, "cold_bytes": 0})
+    for path in paths:
+        for size, kind, name in read_symbols(nm, path):
+            if kind in DATA_TYPES and name.endswith(SITE_DATA):
+                entry = sites[site_function(name)]
+                entry["data_bytes"] += size
+                if name.endswith("::_libassert_params"):
+                    entry["sites"] += 1
+            elif kind in TEXT_TYPES:
+                cold = COLD.match(name)
+                if cold:
+                    function, _ = split_function_name(cold.group(1))
+                    if not function.startswith("libassert::"):
+                        sites[function]["cold_bytes"] += size
+                function, is_template = split_function_name(name)
+                if is_template and function.startswith("libassert::"):
+                    entry = instantiations[function]
+                    entry["symbols"][name] = size
+                    entry["copies"] += 1
+    instantiation_results = [
+        {
+            "template": function,
+            "instantiations": len(entry["symbols"]),
+            "copies": entry["copies"],
+            "bytes": sum(entry["symbols"].values()),
+        }
+        for function, entry in instantiations.items()
+    ]
+    instantiation_results.sort(key=lambda e: e["bytes"], reverse=True)
+    site_results = [
+        dict(function=function, **entry) for function, entry in sites.items() if entry["sites"]
+    ]
+    site_results.sort(key=lambda e: e["data_bytes"] + e["cold_bytes"], reverse=True)
+    return instantiation_results, site_results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Report libassert's contribution to code size")
+    parser.add_argument("files", nargs="+", help="object files, libraries, or binaries")
+    parser.add_argument("--json", action="store_true", help="print a JSON object instead of tables")
+    parser.add_argument("--top", type=int, default=20, help="rows to show per table, 0 for all")
+    parser.add_argument("--nm", default="nm", help="nm executable to use")
+    args = parser.parse_args()
+
+    instantiations, sites = analyze(args.nm, args.files)
+    total_instantiation_bytes = sum(e["bytes"] for e in instantiations)
+    total_sites = sum(e["sites"] for e in sites)
+    if args.json:
+        json.dump(
+            {
+                "instantiation_bytes": total_instantiation_bytes,
+                "sites": total_sites,
+                "instantiations": instantiations,
+                "per_function_sites": sites,
+            },
+            sys.stdout,
+        )
+        print()
+        return
+    top = (lambda rows: rows[: args.top]) if args.top > 0 else (lambda rows: rows)
+    print("libassert template instantiations: {} bytes".format(total_instantiation_bytes))
+    print("{:>10} {:>8} {:>8}  {}".format("bytes", "count", "copies", "template"))
+    for e in top(instantiations):
+        print("{:>10} {:>8} {:>8}  {}".format(e["bytes"], e["instantiations"], e["copies"], e["template"]))
+    print()
+    print("assertion sites: {}".format(total_sites))
+    print("{:>10} {:>10} {:>6}  {}".format("data", "cold", "sites", "function"))
+    for e in top(sites):
+        print("{:>10} {:>10} {:>6}  {}".format(e["data_bytes"], e["cold_bytes"], e["sites"], e["function"]))
+
+
+if __name__ == "__main__":
+    main()
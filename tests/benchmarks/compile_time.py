@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Measures how long translation units using libassert take to compile, for assert-core.hpp and assert.hpp.
+#
+# usage: compile_time.py [--format=text|json] [--filter=substring] [--cxx CXX] [--std STD] [--assertions N]
+#                        [--repetitions N] [--include-dirs DIRS] [--defines DEFINES] [-- extra compiler flags...]
+#
+# DIRS and DEFINES are ;-separated lists, which is what the libassert-compile-bench target passes. Each translation
+# unit is compiled with -c repetitions times and the fastest time is reported, along with the number of headers it
+# pulls in. Only gcc/clang style command lines are supported.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+ASSERTION_TYPES = ["int", "unsigned", "double", "const char*", "std::string", "std::string_view", "long", "char"]
+
+
+def make_source(header, assertions, defines=()):
+    lines = ["#define {}".format(define) for define in defines]
+    lines.append("#include <string>")
+    lines.append("#include <string_view>")
+    if header:
+        lines.append("#include <libassert/{}>".format(header))
+    for i in range(assertions):
+        t = ASSERTION_TYPES[i % len(ASSERTION_TYPES)]
+        lines.append("void check_{}({} a, {} b, int c) {{".format(i, t, t))
+        if header:
+            lines.append('    ASSERT(a == b, "assertion {}", c);'.format(i))
+        else:
+            lines.append("    if(!(a == b)) { __builtin_trap(); }")
+        lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+def cases(assertions):
+    yield "compile/include/none", None, 0, ()
+    yield "compile/include/assert-core.hpp", "assert-core.hpp", 0, ()
+    yield "compile/include/assert.hpp", "assert.hpp", 0, ()
+    prefix = "compile/assertions_{}".format(assertions)
+    yield prefix + "/none", None, assertions, ()
+    yield prefix + "/assert-core.hpp", "assert-core.hpp", assertions, ()
+    yield prefix + "/assert.hpp", "assert.hpp", assertions, ()
+    yield prefix + "/assert.hpp_compact", "assert.hpp", assertions, ("LIBASSERT_COMPACT_CODEGEN",)
+
+
+def run(command):
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    if result.returncode != 0:
+        sys.exit("{} failed:\n{}".format(" ".join(command), result.stderr))
+    return result.stdout
+
+
+def count_headers(base_command, source):
+    # -MM would drop system headers, the standard library is a large part of what's being measured
+    deps = run(base_command + ["-M", source]).replace("\\\n", " ").split()
+    return sum(1 for dep in deps[1:] if dep != source)
+
+
+def measure(base_command, source, obj, repetitions):
+    best = None
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        run(base_command + ["-c", source, "-o", obj])
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best * 1000
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure compile times of translation units using libassert")
+    parser.add_argument("--format", choices=["text", "json"], default="text")
+    parser.add_argument("--filter", default="", help="only run cases whose name contains this")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--std", default="c++17")
+    parser.add_argument("--assertions", type=int, default=100, help="assertions per translation unit")
+    parser.add_argument("--repetitions", type=int, default=3)
+    parser.add_argument("--include-dirs", default="")
+    parser.add_argument("--defines", default="")
+    parser.add_argument("flags", nargs=argparse.REMAINDER, help="extra compiler flags, after --")
+    args = parser.parse_args()
+
+    base_command = [args.cxx, "-std=" + args.std]
+    base_command += ["-I" + d for d in args.include_dirs.split(";") if d]
+    base_command += ["-D" + d for d in args.defines.split(";") if d]
+    base_command += [flag for flag in args.flags if flag != "--"]
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, header, assertions, defines in cases(args.assertions):
+            if args.filter not in name:
+                continue
+            source = os.path.join(tmp, "tu.cpp")
+            with open(source, "w") as f:
+                f.write(make_source(header, assertions, defines))
+            obj = os.path.join(tmp, "tu.o")
+            results.append({"name": name, "value": measure(base_command, source, obj, args.repetitions), "unit": "ms"})
+            results.append({"name": name + "/headers", "value": count_headers(base_command, source), "unit": "files"})
+
+    if args.format == "json":
+        json.dump({"compiler": args.cxx, "std": args.std, "assertions": args.assertions, "results": results}, sys.stdout)
+        print()
+    else:
+        print("{} -std={}".format(args.cxx, args.std))
+        for entry in results:
+            print("{:<50} {:>14.2f} {}".format(entry["name"], entry["value"], entry["unit"]))
+
+
+if __name__ == "__main__":
+    main()
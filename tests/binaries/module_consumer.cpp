@@ -0,0 +1,33 @@
+// Uses libassert the way the README describes for modules: the declarations come from the module, the macros from
+// assert-macros.hpp
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+import libassert;
+#include <libassert/assert-macros.hpp>
+
+void throwing_handler(const libassert::assertion_info& info) {
+    throw std::runtime_error(info.to_string(0, libassert::color_scheme::blank));
+}
+
+int main() {
+    libassert::set_failure_handler(throwing_handler);
+    int x = 3;
+    const std::vector<int> v{1, 2};
+    int& y = ASSERT_VAL(x);
+    DEBUG_ASSERT(&y == &x);
+    std::string message;
+    try {
+        ASSERT(x == 4, "message", v);
+    } catch(const std::runtime_error& e) {
+        message = e.what();
+    }
+    if(
+        message.find("x => 3") == std::string::npos
+        || message.find("v => std::vector<int>: [1, 2]") == std::string::npos
+    ) {
+        return 1;
+    }
+}
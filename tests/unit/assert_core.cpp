@@ -0,0 +1,153 @@
+#include <libassert/assert-core.hpp>
+
+#ifdef LIBASSERT_STRINGIFICATION_HPP
+ #error "assert-core.hpp shouldn't include the stringification micro-library"
+#endif
+#ifdef LIBASSERT_HPP
+ #error "assert-core.hpp shouldn't include assert.hpp"
+#endif
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+// Assertions compiled with only assert-core.hpp available
+
+struct core_opaque {
+    int x;
+    bool operator==(const core_opaque& other) const {
+        return x == other.x;
+    }
+};
+
+struct core_point {
+    int x;
+    int y;
+    bool operator==(const core_point& other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+template<> struct libassert::stringifier<core_point> {
+    std::string stringify(const core_point& p) {
+        return "(" + std::to_string(p.x) + ", " + std::to_string(p.y) + ")";
+    }
+};
+
+enum class core_enum { a = 1, b = 2 };
+
+void core_assert_int(int a, int b) {
+    ASSERT(a == b, "core message", a + b);
+}
+
+void core_assert_value(const char* s) {
+    ASSERT(s);
+}
+
+void core_assert_opaque(core_opaque a, core_opaque b) {
+    ASSERT(a == b);
+}
+
+void core_assert_point(core_point a, core_point b) {
+    ASSERT(a == b);
+}
+
+void core_assert_enum(core_enum a, core_enum b) {
+    ASSERT(a == b);
+}
+
+void core_assert_string(std::string a, const char* b) {
+    ASSERT(a == b, b);
+}
+
+int core_assert_val(int a) {
+    return ASSERT_VAL(a > 2, "too small");
+}
+
+void core_assert_in_range(const std::vector<core_point>& points, const std::vector<int>& xs) {
+    ASSERT_ALL(points, [](const core_point& p) { return p.x < p.y; });
+    ASSERT_ALL_IN_RANGE(xs, 0, 10);
+}
+
+void core_panic() {
+    PANIC("core panic", errno);
+}
+
+// The rest of the test uses the full interface
+
+#include <gtest/gtest.h>
+#include <libassert/assert.hpp>
+
+#include <stdexcept>
+
+namespace {
+    void failure_handler(const libassert::assertion_info& info) {
+        std::string output;
+        output += info.statement(libassert::color_scheme::blank);
+        output += info.print_binary_diagnostics(0, libassert::color_scheme::blank);
+        output += info.print_extra_diagnostics(0, libassert::color_scheme::blank);
+        if(info.message) {
+            output += "message: " + *info.message + "\n";
+        }
+        throw std::runtime_error(output);
+    }
+
+    template<typename F>
+    std::string failure_of(F&& f) {
+        libassert::set_failure_handler(failure_handler);
+        try {
+            f();
+        } catch(const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+
+    bool contains(const std::string& haystack, const std::string& needle) {
+        return haystack.find(needle) != std::string::npos;
+    }
+}
+
+TEST(LibassertCore, BasicTypes) {
+    auto output = failure_of([] { core_assert_int(1, 2); });
+    EXPECT_TRUE(contains(output, "ASSERT(a == b, ...);")) << output;
+    EXPECT_TRUE(contains(output, "a => 1")) << output;
+    EXPECT_TRUE(contains(output, "b => 2")) << output;
+    EXPECT_TRUE(contains(output, "a + b => 3")) << output;
+    EXPECT_TRUE(contains(output, "message: core message")) << output;
+    output = failure_of([] { core_assert_value(nullptr); });
+    EXPECT_TRUE(contains(output, "s => nullptr")) << output;
+    output = failure_of([] { core_assert_string("foo", "bar"); });
+    EXPECT_TRUE(contains(output, "a => \"foo\"")) << output;
+    EXPECT_TRUE(contains(output, "b => \"bar\"")) << output;
+    EXPECT_TRUE(contains(output, "message: bar")) << output;
+    output = failure_of([] { core_assert_enum(core_enum::a, core_enum::b); });
+    EXPECT_TRUE(contains(output, "a => enum core_enum: 1")) << output;
+}
+
+TEST(LibassertCore, CustomTypes) {
+    auto output = failure_of([] { core_assert_point({1, 2}, {3, 4}); });
+    EXPECT_TRUE(contains(output, "a => (1, 2)")) << output;
+    EXPECT_TRUE(contains(output, "b => (3, 4)")) << output;
+    output = failure_of([] { core_assert_opaque({1}, {2}); });
+    EXPECT_TRUE(contains(output, "a => <instance of core_opaque>")) << output;
+}
+
+TEST(LibassertCore, ValueAndPanic) {
+    EXPECT_EQ(core_assert_val(3), 3);
+    auto output = failure_of([] { core_assert_val(1); });
+    EXPECT_TRUE(contains(output, "a => 1")) << output;
+    EXPECT_TRUE(contains(output, "message: too small")) << output;
+    errno = 2;
+    output = failure_of([] { core_panic(); });
+    EXPECT_TRUE(contains(output, "message: core panic")) << output;
+    EXPECT_TRUE(contains(output, "errno =>  2")) << output;
+}
+
+TEST(LibassertCore, RangeAssertions) {
+    auto output = failure_of([] { core_assert_in_range({{1, 2}, {4, 3}}, {}); });
+    EXPECT_TRUE(contains(output, "points[1] => (4, 3)")) << output;
+    output = failure_of([] { core_assert_in_range({}, {1, 2, 11}); });
+    EXPECT_TRUE(contains(output, "ASSERT_ALL_IN_RANGE(xs, 0, 10);")) << output;
+    EXPECT_TRUE(contains(output, "xs[2] => 11")) << output;
+}
@@ -4,13 +4,22 @@
 #include "utils.hpp"
 #include "microfmt.hpp"
 #include "tokenizer.hpp"
+#include "site_cache.hpp"
+#include "trace_cache.hpp"
 
 #include <array>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <list>
 #include <map>
+#include <new>
 #include <optional>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace std::literals;
@@ -838,6 +847,91 @@ TEST(LibassertBasic, Containers) {
     );
 }
 
+TEST(LibassertBasic, RangeDiff) {
+    std::vector<int> a(100);
+    for(int i = 0; i < 100; i++) {
+        a[i] = i;
+    }
+    auto b = a;
+    b[42] = -1;
+    b[70] = -2;
+    b.push_back(100);
+    CHECK(
+        DEBUG_ASSERT(a == b),
+        R"XX(
+        |Debug Assertion failed at <LOCATION>:
+        |    DEBUG_ASSERT(a == b);
+        |    Where:
+        |        a => std::vector<int>: [..., 39, 40, 41, 42, 43, 44, 45, ...]
+        |        b => std::vector<int>: [..., 39, 40, 41, -1, 43, 44, 45, ...]
+        |    Differences:
+        |        size: 100 vs 101
+        |        [42]: 42 vs -1
+        |        [70]: 70 vs -2
+        )XX"
+    );
+    const std::vector<int> prefix(a.begin(), a.begin() + 80);
+    CHECK(
+        DEBUG_ASSERT(a == prefix),
+        R"XX(
+        |Debug Assertion failed at <LOCATION>:
+        |    DEBUG_ASSERT(a == prefix);
+        |    Where:
+        |        a      => std::vector<int>: [..., 77, 78, 79, 80, 81, 82, 83, ...]
+        |        prefix => std::vector<int>: [..., 77, 78, 79]
+        |    Differences:
+        |        size: 100 vs 80
+        )XX"
+    );
+    std::list<std::string> l1(70, "x");
+    std::list<std::string> l2(70, "x");
+    l2.front() = "y";
+    CHECK(
+        DEBUG_ASSERT(l1 == l2),
+        R"XX(
+        |Debug Assertion failed at <LOCATION>:
+        |    DEBUG_ASSERT(l1 == l2);
+        |    Where:
+        |        l1 => std::list<std::string>: ["x", "x", "x", "x", ...]
+        |        l2 => std::list<std::string>: ["y", "x", "x", "x", ...]
+        |    Differences:
+        |        [0]: "x" vs "y"
+        )XX"
+    );
+    const std::vector<int> ones(100, 1);
+    const std::vector<int> twos(100, 2);
+    CHECK(
+        DEBUG_ASSERT(ones == twos),
+        R"XX(
+        |Debug Assertion failed at <LOCATION>:
+        |    DEBUG_ASSERT(ones == twos);
+        |    Where:
+        |        ones => std::vector<int>: [1, 1, 1, 1, ...]
+        |        twos => std::vector<int>: [2, 2, 2, 2, ...]
+        |    Differences:
+        |        [0]: 1 vs 2
+        |        [1]: 1 vs 2
+        |        [2]: 1 vs 2
+        |        [3]: 1 vs 2
+        |        [4]: 1 vs 2
+        |        [5]: 1 vs 2
+        |        [6]: 1 vs 2
+        |        [7]: 1 vs 2
+        |        ... and 92 more differences
+        )XX"
+    );
+    // unordered containers are equal regardless of element order, they're printed as usual
+    std::unordered_set<int> s1;
+    std::unordered_set<int> s2;
+    for(int i = 0; i < 100; i++) {
+        s1.insert(i);
+        s2.insert(i == 50 ? 1000 : i);
+    }
+    WRAP(DEBUG_ASSERT(s1 == s2));
+    EXPECT_NE(assertion_failure_message.find("s1 => std::unordered_set<int>: ["), std::string::npos);
+    EXPECT_EQ(assertion_failure_message.find("Differences:"), std::string::npos);
+}
+
 // TEST(LibassertBasic, TypeCleaning) {}
 
 struct debug_print_customization {
@@ -897,6 +991,574 @@ TEST(LibassertBasic, Panic) {
     );
 }
 
+TEST(LibassertBasic, StringificationBudget) {
+    // values of one assertion share its output budget
+    libassert::set_stringification_budget(0, 32);
+    const std::vector<int> a(10, 12345);
+    const std::vector<int> b(10, 12345);
+    CHECK(
+        PANIC("message", a, b),
+        R"XX(
+        |Panic at <LOCATION>: message
+        |    PANIC(...);
+        |    Extra diagnostics:
+        |        a => std::vector<int>: [12345, 12345, 12345, 12345, ...]
+        |        b => std::vector<int>: ...
+        )XX"
+    );
+    libassert::set_stringification_budget(64 * 1024, 256 * 1024);
+}
+
+TEST(LibassertBasic, RepeatedFailures) {
+    // the same call site failing repeatedly is served from the per-site cache after the first failure
+    std::vector<std::string> messages;
+    std::vector<std::size_t> fills;
+    const int x = 2;
+    for(int i = 0; i < 3; i++) {
+        WRAP(DEBUG_ASSERT(x == x + (i % 2) + 1 == true, "message", i % 2));
+        messages.push_back(assertion_failure_message);
+        fills.push_back(libassert::detail::site_cache_fills());
+    }
+    EXPECT_NE(messages[0], "");
+    EXPECT_NE(messages[0].find("DEBUG_ASSERT(x == x + (i % 2) + 1 == true, ...);"), std::string::npos);
+    EXPECT_NE(messages[0], messages[1]);
+    EXPECT_EQ(messages[0], messages[2]);
+    // nothing new was computed for the later failures
+    EXPECT_EQ(fills[0], fills[1]);
+    EXPECT_EQ(fills[0], fills[2]);
+}
+
+TEST(LibassertBasic, SiteCacheKeys) {
+    // a site's cached decomposition isn't used for a different expression or operator at the same address
+    libassert::detail::assert_static_parameters params{
+        "DEBUG_ASSERT",
+        libassert::assert_type::debug_assertion,
+        "a + 1 == b",
+        {},
+        {},
+        {}
+    };
+    using split = std::pair<std::string, std::string>;
+    EXPECT_EQ(libassert::detail::decompose_expression(&params, "=="), split("a + 1", "b"));
+    const auto fills = libassert::detail::site_cache_fills();
+    EXPECT_EQ(libassert::detail::decompose_expression(&params, "=="), split("a + 1", "b"));
+    EXPECT_EQ(libassert::detail::site_cache_fills(), fills);
+    params.expr_str = "c == d + 1";
+    EXPECT_EQ(libassert::detail::decompose_expression(&params, "=="), split("c", "d + 1"));
+    params.expr_str = "a + 1 < b";
+    EXPECT_EQ(libassert::detail::decompose_expression(&params, "<"), split("a + 1", "b"));
+}
+
+std::atomic<int> deferred_failures = 0;
+std::atomic<bool> deferred_on_other_thread = true;
+std::thread::id main_thread_id;
+
+void counting_failure_handler(const libassert::assertion_info& info) {
+    EXPECT_EQ(info.expression_string, "x == 3");
+    EXPECT_EQ(info.message, "deferred");
+    EXPECT_TRUE(info.binary_diagnostics && info.binary_diagnostics->left_stringification == "2");
+    deferred_on_other_thread = deferred_on_other_thread && std::this_thread::get_id() != main_thread_id;
+    deferred_failures++;
+}
+
+TEST(LibassertBasic, DeferredReporting) {
+    main_thread_id = std::this_thread::get_id();
+    libassert::set_failure_handler(counting_failure_handler);
+    libassert::set_reporting_mode(libassert::reporting_mode::deferred);
+    const int x = 2;
+    for(int i = 0; i < 100; i++) {
+        DEBUG_ASSERT(x == 3, "deferred"); // doesn't throw, the handler runs later on the reporter thread
+    }
+    // failures built in an arena are copied out of it
+    libassert::set_failure_arena_size(1 << 16);
+    for(int i = 0; i < 100; i++) {
+        DEBUG_ASSERT(x == 3, "deferred");
+    }
+    libassert::set_failure_arena_size(0);
+    libassert::flush_deferred_reports();
+    libassert::set_reporting_mode(libassert::reporting_mode::synchronous);
+    libassert::set_failure_handler(failure_handler);
+    EXPECT_EQ(deferred_failures, 200);
+    EXPECT_TRUE(deferred_on_other_thread);
+    // back to synchronous reporting
+    WRAP(DEBUG_ASSERT(x == 3));
+    EXPECT_NE(assertion_failure_message, "");
+}
+
+TEST(LibassertBasic, SampledAssertions) {
+    int evaluated = 0;
+    int failures = 0;
+    auto expensive_check = [&] { evaluated++; return false; };
+    for(int i = 0; i < 10; i++) {
+        WRAP(ASSERT_EVERY_N(4, expensive_check()));
+        failures += assertion_failure_message.empty() ? 0 : 1;
+    }
+    EXPECT_EQ(evaluated, 3); // calls 0, 4 and 8
+    EXPECT_EQ(failures, 3);
+    evaluated = 0;
+    for(int i = 0; i < 1000; i++) {
+        WRAP(ASSERT_SAMPLED(0.0, expensive_check()));
+    }
+    EXPECT_EQ(evaluated, 0);
+    for(int i = 0; i < 10; i++) {
+        WRAP(ASSERT_SAMPLED(1.0, expensive_check()));
+    }
+    EXPECT_EQ(evaluated, 10);
+    // adjusting the rate at runtime
+    auto sampled_site = [&] {
+        ASSERT_SAMPLED(0.0, (evaluated++, true));
+    };
+    const std::uint32_t site_line = __LINE__ - 2;
+    evaluated = 0;
+    sampled_site();
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_EQ(libassert::set_sampling_rate(file, site_line, 1.0), 1);
+    sampled_site();
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(libassert::set_sampling_rate(file, site_line, 0.0), 1);
+    sampled_site();
+    EXPECT_EQ(evaluated, 1);
+}
+
+TEST(LibassertBasic, RangeAssertions) {
+    std::vector<int> v(200);
+    for(int i = 0; i < 200; i++) {
+        v[i] = i;
+    }
+    PASS(ASSERT_ALL(v, [](int x) { return x >= 0; }));
+    PASS(ASSERT_ALL_IN_RANGE(v, 0, 199));
+    v[150] = -1;
+    CHECK(
+        ASSERT_ALL_IN_RANGE(v, 0, 199),
+        R"XX(
+        |Assertion failed at <LOCATION>:
+        |    ASSERT_ALL_IN_RANGE(v, 0, 199);
+        |    Where:
+        |        v[150] => -1
+        )XX"
+    );
+    // the first failing element is reported, and the bound it's outside of
+    const int limit = 100;
+    CHECK(
+        ASSERT_ALL_IN_RANGE(v, 0, limit, "message"),
+        R"XX(
+        |Assertion failed at <LOCATION>: message
+        |    ASSERT_ALL_IN_RANGE(v, 0, limit, ...);
+        |    Where:
+        |        v[101] => 101
+        |        limit  => 100
+        )XX"
+    );
+    CHECK(
+        ASSERT_ALL(v, [](int x) { return x >= 0; }),
+        R"XX(
+        |Assertion failed at <LOCATION>:
+        |    ASSERT_ALL(v, [](int x) { return x >= 0; });
+        |    Where:
+        |        v[150] => -1
+        )XX"
+    );
+    // failures in the elements after the last full block
+    std::vector<double> d(70, 1.5);
+    PASS(ASSERT_NONE_NAN(d));
+    d[68] = std::numeric_limits<double>::quiet_NaN();
+    CHECK(
+        ASSERT_NONE_NAN(d),
+        R"XX(
+        |Assertion failed at <LOCATION>:
+        |    ASSERT_NONE_NAN(d);
+        |    Where:
+        |        d[68] => nan
+        )XX"
+    );
+    const std::list<std::string> names{"foo", "", "bar"};
+    CHECK(
+        ASSERT_ALL(names, [](const std::string& name) { return !name.empty(); }, names.size()),
+        R"XX(
+        |Assertion failed at <LOCATION>:
+        |    ASSERT_ALL(names, [](const std::string& name) { return !name.empty(); }, ...);
+        |    Where:
+        |        names[1] => ""
+        |    Extra diagnostics:
+        |        names.size() => 3
+        )XX"
+    );
+}
+
+struct counted_value {};
+int counted_stringifications = 0;
+
+template<> struct libassert::stringifier<counted_value> {
+    std::string stringify(const counted_value&) {
+        counted_stringifications++;
+        return "counted";
+    }
+};
+
+TEST(LibassertBasic, FailureSuppression) {
+    libassert::set_failure_suppression(3);
+    int reported = 0;
+    const counted_value counted;
+    for(int i = 0; i < 10; i++) {
+        WRAP(ASSERT(i < 0, counted));
+        reported += assertion_failure_message.empty() ? 0 : 1;
+    }
+    // nothing is stringified for suppressed failures
+    EXPECT_EQ(counted_stringifications, 3);
+    // other sites are counted separately
+    WRAP(ASSERT(false));
+    EXPECT_NE(assertion_failure_message, "");
+    // panics are never suppressed
+    for(int i = 0; i < 5; i++) {
+        WRAP(PANIC());
+        reported += assertion_failure_message.empty() ? 0 : 1;
+    }
+    EXPECT_EQ(reported, 8);
+    // after a reset sites report again
+    libassert::reset_failure_suppression();
+    for(int i = 0; i < 10; i++) {
+        WRAP(ASSERT(i < 0));
+        reported += assertion_failure_message.empty() ? 0 : 1;
+    }
+    libassert::set_failure_suppression(0);
+    libassert::reset_failure_suppression();
+    EXPECT_EQ(reported, 11);
+}
+
+// records what was written by the time the report waits on trace resolution
+class header_checking_sink : public libassert::report_sink {
+    const libassert::assertion_info& info;
+public:
+    std::string written;
+    std::string header;
+    bool resolved_before_flush = true;
+    explicit header_checking_sink(const libassert::assertion_info& info_) : info(info_) {}
+    void write(std::string_view str) override {
+        written += str;
+    }
+    void flush() override {
+        header = written;
+        try {
+            (void)info.get_raw_trace();
+            resolved_before_flush = false;
+        } catch(const cpptrace::runtime_error&) {}
+    }
+};
+
+void streaming_failure_handler(const libassert::assertion_info& info) {
+    // the whole header is written before the trace is resolved
+    header_checking_sink checking(info);
+    info.write_report(checking, 0, libassert::color_scheme::blank);
+    EXPECT_FALSE(checking.resolved_before_flush);
+    EXPECT_EQ(checking.header, info.header(0, libassert::color_scheme::blank) + "\nStack trace:\n");
+    const auto expected = info.to_string(0, libassert::color_scheme::blank);
+    std::string streamed;
+    libassert::callback_sink callback(
+        [] (void* context, std::string_view piece) { *static_cast<std::string*>(context) += piece; },
+        &streamed
+    );
+    info.write_report(callback, 0, libassert::color_scheme::blank);
+    EXPECT_EQ(streamed, expected);
+    const auto tagline = info.tagline(libassert::color_scheme::blank);
+    EXPECT_EQ(streamed.substr(0, tagline.size()), tagline);
+    std::array<char, 32> buffer;
+    libassert::buffer_sink fixed(buffer.data(), buffer.size());
+    info.write_report(fixed, 0, libassert::color_scheme::blank);
+    EXPECT_TRUE(fixed.truncated());
+    EXPECT_EQ(fixed.view(), std::string_view(expected).substr(0, buffer.size()));
+    throw std::runtime_error(streamed);
+}
+
+TEST(LibassertBasic, StreamingReports) {
+    libassert::set_failure_handler(streaming_failure_handler);
+    const int x = 2;
+    WRAP(DEBUG_ASSERT(x == 3, "message", x + 1));
+    libassert::set_failure_handler(failure_handler);
+    EXPECT_NE(assertion_failure_message.find("Where:"), std::string::npos);
+    EXPECT_NE(assertion_failure_message.find("Stack trace:"), std::string::npos);
+}
+
+void json_throwing_handler(const libassert::assertion_info& info) {
+    throw std::runtime_error(info.to_json());
+}
+
+TEST(LibassertBasic, JsonOutput) {
+    libassert::set_failure_handler(json_throwing_handler);
+    const std::string s = "a\"b\n";
+    WRAP(DEBUG_ASSERT(s == "x", "message\t", 2));
+    libassert::set_failure_handler(failure_handler);
+    const auto& json = assertion_failure_message;
+    EXPECT_EQ(json.find('\n'), std::string::npos);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find(R"("type":"debug_assertion","macro":"DEBUG_ASSERT","file":)"), std::string::npos);
+    EXPECT_NE(json.find(R"("expression":"s == \"x\"","message":"message\t")"), std::string::npos);
+    EXPECT_NE(json.find(R"("left":{"expression":"s","value":"\"a\\\"b\\n\""})"), std::string::npos);
+    EXPECT_NE(json.find(R"("differences":[],"extra":[{"expression":"2","value":"2"}])"), std::string::npos);
+    EXPECT_NE(json.find(R"("frames":[)"), std::string::npos);
+    std::vector<int> a(100, 1);
+    const std::vector<int> b(101, 1);
+    a[5] = 2;
+    libassert::set_failure_handler(json_throwing_handler);
+    WRAP(DEBUG_ASSERT(a == b));
+    libassert::set_failure_handler(failure_handler);
+    EXPECT_NE(
+        assertion_failure_message.find(R"("differences":["size: 100 vs 101","[5]: 2 vs 1"])"),
+        std::string::npos
+    );
+}
+
+struct out_of_memory_value {};
+
+template<> struct libassert::stringifier<out_of_memory_value> {
+    std::string stringify(const out_of_memory_value&) {
+        throw std::bad_alloc();
+    }
+};
+
+TEST(LibassertBasic, EmergencyReporting) {
+    // allocation failing anywhere in reporting falls back to the reduced report
+    const auto check = [] {
+        const int x = 2;
+        const out_of_memory_value v;
+        DEBUG_ASSERT(x + 1 == 4, v);
+    };
+    EXPECT_DEATH(
+        check(),
+        "Debug Assertion failed at .*assertion_tests.cpp:[0-9]+: .*\n"
+        "    DEBUG_ASSERT\\(x \\+ 1 == 4, \\.\\.\\.\\);\n"
+        "    Where:\n"
+        "        x \\+ 1 => 3\n"
+        "        4 => 4\n"
+        "\\(memory allocation failed while reporting, this is a reduced report\\)\n\n"
+        "Raw stack trace:\n"
+        "#1 0x"
+    );
+    // what was stringified before the allocation failed is kept
+    const auto check_partial = [] {
+        const int x = 2;
+        const int y = 5;
+        const out_of_memory_value v;
+        DEBUG_ASSERT(x + 1 == 4, "message", y, v);
+    };
+    EXPECT_DEATH(
+        check_partial(),
+        "Debug Assertion failed at .*assertion_tests.cpp:[0-9]+: .*: message\n"
+        "    DEBUG_ASSERT\\(x \\+ 1 == 4, \\.\\.\\.\\);\n"
+        "    Where:\n"
+        "        x \\+ 1 => 3\n"
+        "        4 => 4\n"
+        "    Extra diagnostics:\n"
+        "        y => 5\n"
+        "\\(memory allocation failed while reporting"
+    );
+    const auto check_range = [] {
+        const std::vector<int> values{1, 2, 3};
+        const out_of_memory_value v;
+        ASSERT_ALL_IN_RANGE(values, 0, 2, v);
+    };
+    EXPECT_DEATH(
+        check_range(),
+        "    ASSERT_ALL_IN_RANGE\\(values, 0, 2, \\.\\.\\.\\);\n"
+        "    Where:\n"
+        "        values\\[2\\] => 3\n"
+        "        2 => 2\n"
+        "\\(memory allocation failed while reporting"
+    );
+}
+
+void out_of_memory_handler(const libassert::assertion_info&) {
+    throw std::bad_alloc();
+}
+
+TEST(LibassertBasic, FailureHandlerBadAlloc) {
+    // exceptions from the handler itself aren't taken for a failure to build the report
+    libassert::set_failure_handler(out_of_memory_handler);
+    const auto check = [] {
+        const int x = 2;
+        DEBUG_ASSERT(x + 1 == 4);
+    };
+    const auto panic = [] {
+        PANIC();
+    };
+    EXPECT_THROW(check(), std::bad_alloc);
+    EXPECT_THROW(panic(), std::bad_alloc);
+    libassert::set_failure_handler(failure_handler);
+}
+
+// lets a test make every allocation on the current thread fail
+thread_local bool fail_allocations = false;
+
+void* operator new(std::size_t size) {
+    if(!fail_allocations) {
+        if(void* ptr = std::malloc(size == 0 ? 1 : size)) {
+            return ptr;
+        }
+    }
+    throw std::bad_alloc();
+}
+
+void out_of_memory_default_handler(const libassert::assertion_info& info) {
+    fail_allocations = true;
+    libassert::default_failure_handler(info);
+}
+
+void out_of_memory_json_handler(const libassert::assertion_info& info) {
+    fail_allocations = true;
+    libassert::json_failure_handler(info);
+}
+
+TEST(LibassertBasic, BuiltinHandlerBadAlloc) {
+    // the built-in handlers fall back to the reduced report when writing the full one runs out of memory
+    const auto check = [] {
+        const int x = 2;
+        DEBUG_ASSERT(x + 1 == 4);
+    };
+    const auto panic = [] {
+        PANIC("message");
+    };
+    // the diagnostics were already built, only writing them out needed the heap
+    const char* reduced_report =
+        "    DEBUG_ASSERT\\(x \\+ 1 == 4\\);\n"
+        "    Where:\n"
+        "        x \\+ 1 => 3\n"
+        "\\(memory allocation failed while reporting, this is a reduced report\\)\n\n"
+        "Raw stack trace:\n";
+    libassert::set_failure_handler(out_of_memory_default_handler);
+    EXPECT_DEATH(check(), std::string("Debug Assertion failed at .*assertion_tests.cpp:[0-9]+: .*\n") + reduced_report);
+    EXPECT_DEATH(
+        panic(),
+        "Panic at .*: message\n    PANIC\\(\\.\\.\\.\\);\n\\(memory allocation failed while reporting"
+    );
+    libassert::set_failure_handler(out_of_memory_json_handler);
+    EXPECT_DEATH(check(), reduced_report);
+    libassert::set_failure_handler(failure_handler);
+}
+
+std::optional<libassert::assertion_info> saved_info;
+bool copy_before_formatting = false;
+
+bool in_arena(const libassert::arena_string& str) {
+    return str.get_allocator().get_arena() != nullptr;
+}
+
+void arena_failure_handler(const libassert::assertion_info& info) {
+    if(copy_before_formatting) {
+        saved_info = info;
+    }
+    const auto report = info.to_string(0, libassert::color_scheme::blank); // sets up path handling in the arena
+    if(!copy_before_formatting) {
+        saved_info = info;
+    }
+    EXPECT_NE(info.get_allocator().get_arena(), nullptr);
+    EXPECT_TRUE(in_arena(*info.message));
+    EXPECT_TRUE(in_arena(info.binary_diagnostics->left_stringification));
+    EXPECT_TRUE(in_arena(info.extra_diagnostics.at(0).stringification));
+    EXPECT_EQ(saved_info->get_allocator().get_arena(), nullptr);
+    EXPECT_FALSE(in_arena(*saved_info->message));
+    EXPECT_FALSE(in_arena(saved_info->binary_diagnostics->left_stringification));
+    EXPECT_FALSE(in_arena(saved_info->extra_diagnostics.at(0).stringification));
+    throw std::runtime_error(report);
+}
+
+void check_failure_arena() {
+    libassert::set_failure_arena_size(1 << 16);
+    libassert::set_failure_handler(arena_failure_handler);
+    const int x = 2;
+    std::vector<std::string> messages;
+    for(int i = 0; i < 3; i++) {
+        WRAP(DEBUG_ASSERT(x == 3, "message", x));
+        messages.push_back(assertion_failure_message);
+    }
+    // copies taken in the handler don't refer to the arena, which has since been reset and reused
+    const auto saved = saved_info->to_string(0, libassert::color_scheme::blank);
+    libassert::set_failure_arena_size(0);
+    libassert::set_failure_handler(failure_handler);
+    WRAP(DEBUG_ASSERT(x == 3));
+    saved_info.reset();
+    EXPECT_NE(messages[0], "");
+    EXPECT_EQ(messages[0], messages[1]);
+    EXPECT_EQ(messages[0], messages[2]);
+    EXPECT_EQ(saved, messages[0]);
+    EXPECT_NE(assertion_failure_message, "");
+}
+
+TEST(LibassertBasic, FailureArena) {
+    copy_before_formatting = false;
+    check_failure_arena();
+}
+
+TEST(LibassertBasic, FailureArenaCopyThenFormat) {
+    // the copy builds its own path handler, which mustn't end up in the arena either
+    copy_before_formatting = true;
+    check_failure_arena();
+    copy_before_formatting = false;
+}
+
+TEST(LibassertBasic, TraceCache) {
+    auto raw_trace = cpptrace::generate_raw_trace();
+    auto expected = raw_trace.resolve();
+    // the first call fills the cache, the second is served from it
+    EXPECT_EQ(libassert::detail::resolve_cached(raw_trace).frames, expected.frames);
+    EXPECT_EQ(libassert::detail::resolve_cached(raw_trace).frames, expected.frames);
+    // a different trace sharing most of its addresses
+    raw_trace.frames.erase(raw_trace.frames.begin());
+    EXPECT_EQ(libassert::detail::resolve_cached(raw_trace).frames, raw_trace.resolve().frames);
+}
+
+cpptrace::stacktrace_frame make_frame(cpptrace::frame_ptr address, std::string symbol, bool is_inline) {
+    cpptrace::stacktrace_frame frame{};
+    frame.raw_address = address;
+    frame.symbol = std::move(symbol);
+    frame.is_inline = is_inline;
+    return frame;
+}
+
+TEST(LibassertBasic, TraceCacheInlinedFrames) {
+    using frame_map = std::unordered_map<cpptrace::frame_ptr, std::vector<cpptrace::stacktrace_frame>>;
+    const std::vector<cpptrace::frame_ptr> addresses = { 0x100, 0x200, 0x300 };
+    // inlined frames are attributed by position, whatever address they report
+    cpptrace::stacktrace trace;
+    trace.frames = {
+        make_frame(0, "a_inline_1", true),
+        make_frame(0, "a_inline_2", true),
+        make_frame(0x100, "a", false),
+        make_frame(0x200, "b", false),
+        make_frame(0x350, "c_inline", true),
+        make_frame(0x300, "c", false)
+    };
+    frame_map frames;
+    EXPECT_TRUE(libassert::detail::split_frames(addresses, trace, frames));
+    ASSERT_EQ(frames.size(), 3);
+    ASSERT_EQ(frames[0x100].size(), 3);
+    EXPECT_EQ(frames[0x100][0].symbol, "a_inline_1");
+    EXPECT_EQ(frames[0x100][2].symbol, "a");
+    ASSERT_EQ(frames[0x200].size(), 1);
+    EXPECT_EQ(frames[0x200][0].symbol, "b");
+    ASSERT_EQ(frames[0x300].size(), 2);
+    EXPECT_EQ(frames[0x300][0].symbol, "c_inline");
+    EXPECT_EQ(frames[0x300][1].symbol, "c");
+    // frames that don't line up are still all kept, in order
+    trace.frames = { make_frame(0x100, "a", false), make_frame(0x200, "b_inline", true) };
+    frames.clear();
+    EXPECT_FALSE(libassert::detail::split_frames(addresses, trace, frames));
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(frames[0x100][0].symbol, "a");
+    EXPECT_EQ(frames[0x200][0].symbol, "b_inline");
+    ASSERT_EQ(frames[0x300].size(), 1);
+    EXPECT_EQ(frames[0x300][0].raw_address, 0x300);
+    trace.frames = {
+        make_frame(0x100, "a", false),
+        make_frame(0x200, "b", false),
+        make_frame(0x300, "c", false),
+        make_frame(0x400, "d", false)
+    };
+    frames.clear();
+    EXPECT_FALSE(libassert::detail::split_frames(addresses, trace, frames));
+    ASSERT_EQ(frames[0x300].size(), 2);
+    EXPECT_EQ(frames[0x300][1].symbol, "d");
+}
+
 // TODO:
 // basic assertion failures
 // extra diagnostics
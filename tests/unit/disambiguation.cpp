@@ -46,5 +46,31 @@ int main() {
             ok = false;
         }
     }
+    // compile-time splits must agree with the runtime analysis whenever they resolve
+    static_assert(libassert::detail::decompose_expression_static("a == b", "==").resolved);
+    static_assert(!libassert::detail::decompose_expression_static("a < b", "==").resolved);
+    std::tuple<std::string_view, std::string_view, bool> static_tests[] = {
+        {"a == b", "==", true},
+        {"foo(a, b) != bar[1 + 2]", "!=", true},
+        {"x->y & 0x1'00ULL", "&", true},
+        {"1.5e-3 <= f()", "<=", true},
+        {"s == \"a == b\"", "==", true},
+        {"c == '\\''", "==", true},
+        {"a == b == c", "==", false}, // <- more than one candidate
+        {"a < 1 == 2 > ( 1 + 3 )", "==", false}, // <- possible template
+        {"a not_eq b", "!=", false}, // <- alternative token
+        {"a ? b : c == d", "==", false}, // <- lower precedence operator
+        {"s == R\"(x)\"", "==", false} // <- raw string
+    };
+    for(auto [expression, target_op, should_resolve] : static_tests) {
+        auto decomposition = libassert::detail::decompose_expression_static(expression, target_op);
+        bool passed = decomposition.resolved == should_resolve;
+        if(decomposition.resolved) {
+            auto [l, r] = libassert::detail::decompose_expression(expression, target_op);
+            passed = passed && l == decomposition.left && r == decomposition.right;
+        }
+        std::cout<<expression<<" target: "<<target_op<<" "<<(passed ? GREEN "Passed" RESET : RED "Failed" RESET)<<std::endl;
+        ok = ok && passed;
+    }
     return !ok;
 }
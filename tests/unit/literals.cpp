@@ -2,12 +2,11 @@
 #include <cstdio>
 #include <cstdlib>
 #include <initializer_list>
-#include <regex>
 #include <string_view>
 #include <string>
 #include <vector>
 
-#include "microfmt.hpp"
+#include "tokenizer.hpp"
 
 inline std::vector<std::string> split(std::string_view s, std::string_view delim) {
     std::vector<std::string> vec;
@@ -75,6 +74,12 @@ int main() {
         0x1p2
         1e2
         1e2f
+        'a'
+        '\n'
+        '\x1f'
+        '\033'
+        u8'a'
+        L'a'
     )QQ";
     std::string dont_match_raw = R"QQ(
         0B
@@ -121,6 +126,9 @@ int main() {
         0'x1p2
         1'e2
         1e2f'
+        'a
+        u'a
+        x'a'
     )QQ";
     let match_cases = split(trim(match_raw), "\n");
     let dont_match_cases = split(trim(dont_match_raw), "\n");
@@ -129,35 +137,8 @@ int main() {
             item = trim(item);
         }
     }
-    static std::string optional_integer_suffix = "(?:[Uu](?:LL?|ll?|Z|z)?|(?:LL?|ll?|Z|z)[Uu]?)?";
-    static std::regex int_binary  = std::regex("^0[Bb][01](?:'?[01])*" + optional_integer_suffix + "$");
-    static std::regex int_octal   = std::regex("^0(?:'?[0-7])+" + optional_integer_suffix + "$");
-    static std::regex int_decimal = std::regex("^(?:0|[1-9](?:'?\\d)*)" + optional_integer_suffix + "$");
-    static std::regex int_hex     = std::regex("^0[Xx](?!')(?:'?[\\da-fA-F])+" + optional_integer_suffix + "$");
-
-    static std::string digit_sequence = "\\d(?:'?\\d)*";
-    static std::string fractional_constant = libassert::microfmt::format("(?:(?:{})?\\.{}|{}\\.)", digit_sequence, digit_sequence, digit_sequence);
-    static std::string exponent_part = "(?:[Ee][\\+-]?" + digit_sequence + ")";
-    static std::string suffix = "[FfLl]";
-    static std::regex float_decimal = std::regex(libassert::microfmt::format("^(?:{}{}?|{}{}){}?$",
-                                    fractional_constant, exponent_part,
-                                    digit_sequence, exponent_part, suffix));
-    static std::string hex_digit_sequence = "[\\da-fA-F](?:'?[\\da-fA-F])*";
-    static std::string hex_frac_const = libassert::microfmt::format("(?:(?:{})?\\.{}|{}\\.)", hex_digit_sequence, hex_digit_sequence, hex_digit_sequence);
-    static std::string binary_exp = "[Pp][\\+-]?" + digit_sequence;
-    static std::regex float_hex = std::regex(libassert::microfmt::format("^0[Xx](?:{}|{}){}{}?$",
-                                    hex_frac_const, hex_digit_sequence, binary_exp, suffix));
     let matches_any = [&](const std::string& str) {
-        let matches = [](const std::string& value, const std::regex& re) {
-            std::smatch base_match;
-            return std::regex_match(value, base_match, re);
-        };
-        return matches(str, int_binary)
-            || matches(str, int_octal)
-            || matches(str, int_decimal)
-            || matches(str, int_hex)
-            || matches(str, float_decimal)
-            || matches(str, float_hex);
+        return libassert::detail::classify_literal(str).has_value();
     };
     bool ok = true;
     for(let const& item : match_cases) {
@@ -0,0 +1,102 @@
+#define LIBASSERT_SITE_COUNTERS
+#include <libassert/assert.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Assertions compiled with per-site counters
+
+void throwing_handler(const libassert::assertion_info& info) {
+    throw std::runtime_error(info.to_string(0, libassert::color_scheme::blank));
+}
+
+void counted_assert(int x) {
+    ASSERT(x < 10);
+}
+
+int counted_assert_val(int x) {
+    return ASSERT_VAL(x);
+}
+
+void counted_assert_all(const std::vector<int>& v) {
+    ASSERT_ALL_IN_RANGE(v, 0, 100);
+}
+
+template<typename T> void counted_template(T x) {
+    ASSERT(x > 0);
+}
+
+const libassert::site_counts* find_site(const std::vector<libassert::site_counts>& counts, std::string_view expr) {
+    auto it = std::find_if(counts.begin(), counts.end(), [&](const auto& site) { return site.expression == expr; });
+    return it == counts.end() ? nullptr : &*it;
+}
+
+TEST(LibassertSiteCounters, CountsEvaluationsAndFailures) {
+    libassert::set_failure_handler(throwing_handler);
+    libassert::reset_site_counts();
+    for(int i = 0; i < 12; i++) {
+        try {
+            counted_assert(i);
+        } catch(const std::runtime_error&) {}
+    }
+    for(int i = 0; i < 3; i++) {
+        try {
+            counted_assert_val(i);
+        } catch(const std::runtime_error&) {}
+    }
+    counted_assert_all({1, 2, 3});
+    EXPECT_THROW(counted_assert_all({1, 200}), std::runtime_error);
+    const auto counts = libassert::get_site_counts();
+    const auto* assert_site = find_site(counts, "x < 10");
+    ASSERT_NE(assert_site, nullptr);
+    EXPECT_EQ(assert_site->macro_name, "ASSERT");
+    EXPECT_EQ(assert_site->evaluations, 12U);
+    EXPECT_EQ(assert_site->failures, 2U);
+    EXPECT_NE(assert_site->file.find("site_counters.cpp"), std::string_view::npos);
+    const auto* val_site = find_site(counts, "x");
+    ASSERT_NE(val_site, nullptr);
+    EXPECT_EQ(val_site->macro_name, "ASSERT_VAL");
+    EXPECT_EQ(val_site->evaluations, 3U);
+    EXPECT_EQ(val_site->failures, 1U);
+    const auto* range_site = find_site(counts, "v, 0, 100");
+    ASSERT_NE(range_site, nullptr);
+    EXPECT_EQ(range_site->macro_name, "ASSERT_ALL_IN_RANGE");
+    EXPECT_EQ(range_site->evaluations, 2U);
+    EXPECT_EQ(range_site->failures, 1U);
+    // most evaluated first
+    EXPECT_EQ(counts.front().expression, "x < 10");
+    libassert::reset_site_counts();
+    EXPECT_EQ(find_site(libassert::get_site_counts(), "x < 10")->evaluations, 0U);
+}
+
+TEST(LibassertSiteCounters, MergesTemplateInstantiations) {
+    libassert::reset_site_counts();
+    counted_template(1);
+    counted_template(2.0);
+    counted_template(3L);
+    const auto counts = libassert::get_site_counts();
+    EXPECT_EQ(
+        std::count_if(counts.begin(), counts.end(), [](const auto& site) { return site.expression == "x > 0"; }),
+        1
+    );
+    EXPECT_EQ(find_site(counts, "x > 0")->evaluations, 3U);
+}
+
+TEST(LibassertSiteCounters, WriteSiteCounts) {
+    libassert::reset_site_counts();
+    counted_assert(1);
+    std::string report;
+    libassert::callback_sink callback(
+        [] (void* context, std::string_view piece) { *static_cast<std::string*>(context) += piece; },
+        &report
+    );
+    libassert::write_site_counts(callback);
+    EXPECT_EQ(report.find("         evaluations             failures  site\n"), 0U);
+    EXPECT_NE(report.find("                   1                    0  "), std::string::npos);
+    EXPECT_NE(report.find("ASSERT(x < 10)\n"), std::string::npos);
+}
@@ -1,8 +1,13 @@
 #undef ASSERT_LOWERCASE
 #include <libassert/assert-gtest.hpp>
 
+#if defined(LIBASSERT_PRECOMPILED_STRINGIFICATIONS) || defined(LIBASSERT_EXTERN_STRINGIFICATION)
+ #error "stringification.hpp's helper macros shouldn't leak"
+#endif
+
 #include <array>
 #include <filesystem>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
@@ -37,6 +42,15 @@ TEST(Stringify, BasicTypes) {
     ASSERT(generate_stringification(2.25) == R"(2.25)");
 }
 
+TEST(Stringify, NonFiniteFloats) {
+    // only finite values get a ".0" when they don't have a '.'
+    ASSERT(generate_stringification(2.0) == R"(2.0)");
+    ASSERT(generate_stringification(std::numeric_limits<double>::infinity()) == R"(inf)");
+    ASSERT(generate_stringification(-std::numeric_limits<float>::infinity()) == R"(-inf)");
+    ASSERT(generate_stringification(std::numeric_limits<double>::quiet_NaN()) == R"(nan)");
+    ASSERT(generate_stringification(std::numeric_limits<float>::quiet_NaN()) == R"(nan)");
+}
+
 TEST(Stringify, Pointers) {
     ASSERT(generate_stringification(nullptr) == R"(nullptr)");
     int x;
@@ -69,6 +83,100 @@ TEST(Stringify, Strings) {
     ASSERT(generate_stringification(R"("foobar")") == R"xx("\"foobar\"")xx");
 }
 
+TEST(Stringify, LongStrings) {
+    // long enough to go through the vectorized scan, with escapes at every position relative to the chunk boundaries
+    const std::string clean(100, 'a');
+    ASSERT(generate_stringification(clean) == '"' + clean + '"');
+    for(std::size_t i = 0; i < clean.size(); i++) {
+        for(const auto& [c, escaped] : {
+            std::pair{'\n', "\\n"s}, std::pair{'"', "\\\""s}, std::pair{'\\', "\\\\"s},
+            std::pair{'\x7f', "\\x7f"s}, std::pair{'\x80', "\\x80"s}, std::pair{'\x01', "\\x01"s}
+        }) {
+            std::string str = clean;
+            str[i] = c;
+            ASSERT(
+                generate_stringification(str) == '"' + clean.substr(0, i) + escaped + clean.substr(i + 1) + '"',
+                i
+            );
+        }
+    }
+}
+
+TEST(Stringify, Budget) {
+    libassert::set_stringification_budget(32, 0);
+    const auto a = generate_stringification(std::string(100, 'a'));
+    const auto vec = generate_stringification(std::vector<int>(100, 12345));
+    const auto nested = generate_stringification(std::vector<std::vector<std::string>>(10, {10, "foo"}));
+    const auto tuple = generate_stringification(std::make_tuple(1, std::string(100, 'b'), 3));
+    const auto small = generate_stringification(std::vector<int>{1, 2, 3});
+    libassert::set_stringification_budget(64 * 1024, 256 * 1024);
+    ASSERT(a == '"' + std::string(27, 'a') + R"("...)");
+    ASSERT(vec == R"(std::vector<int>: [12345, 12345, 12345, 12345, ...])");
+    ASSERT(nested.find(R"([["foo", "foo", "foo", "foo", ...], ...])") != std::string::npos, nested);
+    ASSERT(tuple.find(R"([1, "bbbbbbbbbbbbbbbbbbbbbbbb"..., ...])") != std::string::npos, tuple);
+    ASSERT(small == R"(std::vector<int>: [1, 2, 3])");
+    ASSERT(generate_stringification(std::vector<int>(100, 12345)).size() > 600);
+}
+
+// writes until the stream stops taking output
+struct endless_printable {};
+int endless_writes = 0;
+
+std::ostream& operator<<(std::ostream& os, endless_printable) {
+    for(endless_writes = 0; endless_writes < 1000000 && os; endless_writes++) {
+        os << "0123456789";
+    }
+    return os;
+}
+
+TEST(Stringify, OstreamBudget) {
+    // operator<< is cut off once the output is past the budget
+    libassert::set_stringification_budget(32, 0);
+    const auto endless = generate_stringification(endless_printable{});
+    libassert::set_stringification_budget(64 * 1024, 256 * 1024);
+    ASSERT(endless == "...");
+    ASSERT(endless_writes <= 4, endless_writes);
+}
+
+struct ellipsis {};
+
+template<> struct libassert::stringifier<ellipsis> {
+    std::string stringify(const ellipsis&) {
+        return "...";
+    }
+};
+
+// one of the types stringification is precompiled for, without LIBASSERT_PRECOMPILED_STRINGIFICATION the
+// specialization is used
+template<> struct libassert::stringifier<std::tuple<int, int, int>> {
+    std::string stringify(const std::tuple<int, int, int>& t) {
+        return "custom " + std::to_string(std::get<0>(t) + std::get<1>(t) + std::get<2>(t));
+    }
+};
+
+TEST(Stringify, StringifyInto) {
+    std::string out = "prefix ";
+    do_stringify_into(out, std::vector<std::optional<std::string>>{"a\n", {}, "b"});
+    ASSERT(out == R"(prefix ["a\n", nullopt, "b"])");
+    out.clear();
+    do_stringify_into(out, std::make_tuple(2, std::vector<ostream_printable>{{1}, {2}}, 'c'));
+    ASSERT(out == R"([2, [{1}, {2}], 'c'])");
+    ASSERT(do_stringify(std::vector<std::shared_ptr<int>>{std::make_shared<int>(5), nullptr}) == "[5, nullptr]");
+    ASSERT(do_stringify(std::map<std::string, ostream_printable>{{"x", {3}}}) == R"([["x", {3}]])");
+    libassert::set_stringification_budget(16, 0);
+    const auto elided = generate_stringification(std::vector<ostream_printable>(10, {12345}));
+    libassert::set_stringification_budget(64 * 1024, 256 * 1024);
+    ASSERT(elided == R"(std::vector<ostream_printable>: [{12345}, {12345}, ...])");
+    // a value that stringifies to the elision marker doesn't cut the rest short
+    ASSERT(do_stringify(std::vector<ellipsis>(3)) == "[..., ..., ...]");
+    ASSERT(do_stringify(std::make_tuple(ellipsis{}, 1, 2)) == "[..., 1, 2]");
+}
+
+TEST(Stringify, StringifierForPrecompiledType) {
+    ASSERT(do_stringify(std::make_tuple(1, 2, 3)) == "custom 6");
+    ASSERT(generate_stringification(std::make_tuple(1, 2, 3)) == "std::tuple<int, int, int>: custom 6");
+}
+
 #if __GNUC__ >= 9
 // Somehow bugged for gcc 8, resulting in a segfault on std::filesystem::path::~path(). This happens completely
 // independent of anything cpptrace, some awful ABI issue and I can't be bothered to figure it out. Can't repro on CE.
@@ -194,6 +302,18 @@ TEST(Stringify, LiteralFormatting) {
     libassert::set_fixed_literal_format(libassert::literal_format::integer_hex | libassert::literal_format::integer_octal);
     libassert::detail::set_literal_format("", "", "", false);
     ASSERT(generate_stringification(100) == "100 0x64 0144");
+    ASSERT(generate_stringification(0) == "0 0 0");
+    ASSERT(generate_stringification(short(-1)) == "-1 0xffff 0177777");
+    libassert::set_fixed_literal_format(libassert::literal_format::integer_binary);
+    libassert::detail::set_literal_format("", "", "", false);
+    ASSERT(generate_stringification(short(5)) == "5 0b0000000000000101");
+    ASSERT(generate_stringification(-2) == "-2 0b11111111111111111111111111111110");
+    libassert::set_fixed_literal_format(libassert::literal_format::float_hex);
+    libassert::detail::set_literal_format("", "", "", false);
+    ASSERT(generate_stringification(1.0) == "1.0 0x1p+0.0");
+    ASSERT(generate_stringification(-0.1) == "-0.10000000000000001 -0x1.999999999999ap-4");
+    ASSERT(generate_stringification(1e-40f) == "9.9999461e-41 0x1.16c2p-133");
+    libassert::detail::set_thread_current_literal_format(libassert::literal_format::default_format);
     libassert::set_literal_format_mode(libassert::literal_format_mode::infer);
 
     std::tuple<A, B, C> tuple2;